@@ -0,0 +1,222 @@
+/*
+	AsyncLoader.h
+	+-------------------------------------------------------------+
+	|         OneLoneCoder Pixel Game Engine Extension            |
+	|                AsyncLoader - v0.1.0                         |
+	+-------------------------------------------------------------+
+
+	What is this?
+	~~~~~~~~~~~~~
+	Loads images into Renderables in the background. Files are read and
+	decoded on the threads of an olc::ThreadPool, many at a time. Textures 
+	can only be created on the engine thread, so Update() turns the 
+	decoded images into decals, a limited number per frame if needed.
+
+	Until then the Renderable has no Decal. RenderBatch skips such 
+	Renderables, or draws its placeholder instead, see 
+	RenderBatch::SetPlaceholder().
+
+	Loading from a ResourcePack is safe from many threads at once, the
+	pack is only read.
+
+	For example on how to use, see RenderBatchDemo.cpp.
+
+
+	License (OLC-3)
+	~~~~~~~~~~~~~~~
+
+	Copyright 2018 - 2021 OneLoneCoder.com
+
+	Redistribution and use in source and binary forms, with or without modification,
+	are permitted provided that the following conditions are met:
+
+	1. Redistributions or derivations of source code must retain the above copyright
+	notice, this list of conditions and the following disclaimer.
+
+	2. Redistributions or derivative works in binary form must reproduce the above
+	copyright notice. This list of conditions and the following	disclaimer must be
+	reproduced in the documentation and/or other materials provided with the distribution.
+
+	3. Neither the name of the copyright holder nor the names of its contributors may
+	be used to endorse or promote products derived from this software without specific
+	prior written permission.
+
+	THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS	"AS IS" AND ANY
+	EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+	OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+	SHALL THE COPYRIGHT	HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+	INCIDENTAL,	SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+	TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+	BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+	CONTRACT, STRICT LIABILITY, OR TORT	(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+	ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+	SUCH DAMAGE.
+
+	Links
+	~~~~~
+	Homepage:	https://github.com/codesmith-fi
+	Mail:		codesmith.fi@gmail.com
+
+	Author
+	~~~~~~
+	Erno Pakarinen (aka xanaki#9472 in discord, aka codesmith-fi)
+
+*/
+
+#ifndef __ASYNCLOADER_H_DEFINED__
+#define __ASYNCLOADER_H_DEFINED__
+
+#include <string>
+#include <memory>
+#include <deque>
+#include <future>
+#include <mutex>
+#include <condition_variable>
+#include <limits>
+
+#include "ThreadPool.h"
+
+namespace olc {
+
+class AsyncLoader
+{
+public:
+	/// Decode on the threads of _pool, which must outlive the loader
+	explicit AsyncLoader(olc::ThreadPool& _pool) : m_pool(_pool) { };
+	/// Waits for the images being decoded. Their Renderables are left
+	/// empty and the futures return olc::rcode::FAIL.
+	virtual ~AsyncLoader();
+
+	AsyncLoader(const AsyncLoader&) = delete;
+	AsyncLoader& operator=(const AsyncLoader&) = delete;
+
+	/// Start loading _file into _renderable, like Renderable::Load(). 
+	/// _renderable must stay alive until the future is ready. The future
+	/// becomes ready in the Update() which creates the Decal, or when
+	/// loading fails, with the result of the load.
+	std::shared_future<olc::rcode> Load(olc::Renderable* _renderable, const std::string& _file,
+		olc::ResourcePack* _pack = nullptr, bool _filter = false, bool _clamp = true);
+
+	/// Create the Decals of at most _maxDecals decoded images. Call on the
+	/// engine thread, e.g. once per frame in OnUserUpdate(). Returns the
+	/// number of Renderables completed.
+	size_t Update(size_t _maxDecals = std::numeric_limits<size_t>::max());
+
+	/// Block until every Load() is complete, calling Update() as images
+	/// are decoded. Engine thread only.
+	void Wait();
+
+	/// Number of loads which are not complete yet
+	size_t Pending() const;
+
+private:
+	struct Request
+	{
+		olc::Renderable* renderable = nullptr;
+		std::unique_ptr<olc::Sprite> sprite;
+		olc::rcode result = olc::rcode::FAIL;
+		bool filter = false;
+		bool clamp = true;
+		std::promise<olc::rcode> promise;
+	};
+
+	olc::ThreadPool& m_pool;
+	mutable std::mutex m_mutex;
+	std::condition_variable m_decoded;
+	// Decoded images waiting for Update()
+	std::deque<std::shared_ptr<Request>> m_ready;
+	// Requests on the pool, and all requests not complete yet
+	size_t m_decoding = 0;
+	size_t m_pending = 0;
+};
+
+} // namespace olc
+
+#ifdef OLC_PGEX_ASYNCLOADER
+#undef OLC_PGEX_ASYNCLOADER
+
+namespace olc {
+	AsyncLoader::~AsyncLoader()
+	{
+		std::unique_lock<std::mutex> lock(m_mutex);
+		m_decoded.wait(lock, [this] { return m_decoding == 0; });
+		for (auto& request : m_ready) {
+			request->promise.set_value(olc::rcode::FAIL);
+		}
+	}
+
+	std::shared_future<olc::rcode> AsyncLoader::Load(olc::Renderable* _renderable, const std::string& _file,
+		olc::ResourcePack* _pack, bool _filter, bool _clamp)
+	{
+		std::shared_ptr<Request> request = std::make_shared<Request>();
+		request->renderable = _renderable;
+		request->filter = _filter;
+		request->clamp = _clamp;
+		std::shared_future<olc::rcode> future = request->promise.get_future().share();
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			++m_decoding;
+			++m_pending;
+		}
+
+		// std::function needs a copyable task, so the request is shared
+		m_pool.Submit([this, request, _file, _pack]() {
+			request->sprite.reset(new olc::Sprite());
+			request->result = request->sprite->LoadFromFile(_file, _pack);
+			// Notify under the lock, the destructor may free the loader as
+			// soon as it sees m_decoding reach 0
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_ready.push_back(request);
+			--m_decoding;
+			m_decoded.notify_all();
+		});
+		return future;
+	}
+
+	size_t AsyncLoader::Update(size_t _maxDecals)
+	{
+		size_t done = 0;
+		while (done < _maxDecals) {
+			std::shared_ptr<Request> request;
+			{
+				std::lock_guard<std::mutex> lock(m_mutex);
+				if (m_ready.empty()) {
+					break;
+				}
+				request = std::move(m_ready.front());
+				m_ready.pop_front();
+			}
+			if (request->result == olc::rcode::OK) {
+				request->renderable->Create(std::move(request->sprite), request->filter, request->clamp);
+			}
+			request->promise.set_value(request->result);
+			{
+				std::lock_guard<std::mutex> lock(m_mutex);
+				--m_pending;
+			}
+			++done;
+		}
+		return done;
+	}
+
+	void AsyncLoader::Wait()
+	{
+		for (;;) {
+			Update();
+			std::unique_lock<std::mutex> lock(m_mutex);
+			if (m_pending == 0) {
+				return;
+			}
+			m_decoded.wait(lock, [this] { return !m_ready.empty(); });
+		}
+	}
+
+	size_t AsyncLoader::Pending() const
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		return m_pending;
+	}
+} // namespace olc
+
+#endif // OLC_PGEX_ASYNCLOADER
+#endif // __ASYNCLOADER_H_DEFINED__
@@ -0,0 +1,63 @@
+/*
+	CompactBench.cpp
+
+	RenderBatch::SetCompact() against the list mode: 20000 32x32 sprites
+	with random Z in Z_INC order, Begin() + Draw() + End() into a null
+	renderer. Best of 10 frames, 3 for the slow list mode.
+
+	g++ -std=c++14 -O2 CompactBench.cpp -o CompactBench -lX11 -lGL -lpng -lpthread -lstdc++fs
+*/
+#define OLC_PGE_APPLICATION
+#include "../pge/olcPixelGameEngine.h"
+#define OLC_PGEX_RENDERBATCH
+#include "../RenderBatch.h"
+#include "NullRenderer.h"
+
+#include <cstdio>
+#include <random>
+
+int main()
+{
+	BenchEngine engine;
+	olc::Renderable sprites[4];
+	for (auto& sprite : sprites) {
+		sprite.Create(32, 32);
+	}
+
+	const int count = 20000;
+	std::mt19937 rng(1);
+	std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+	std::vector<olc::vf2d> positions;
+	std::vector<float> depths;
+	for (int n = 0; n < count; ++n) {
+		positions.push_back(olc::vf2d(unit(rng) * 608.0f, unit(rng) * 448.0f));
+		depths.push_back(unit(rng));
+	}
+
+	printf("%d entries, Z_INC, random Z\n", count);
+	printf("  entry size: list node %zu bytes, compact %zu bytes\n",
+		sizeof(olc::RenderBatchEntry) + 2 * sizeof(void*), sizeof(olc::RenderBatchCompactEntry));
+	for (int compact = 0; compact < 2; ++compact) {
+		olc::RenderBatch batch(olc::RenderBatch::DrawOrder::Z_INC);
+		batch.SetCompact(compact != 0);
+		// Best frame and best End() alone, most of the list mode time
+		// is in the sorted insert of Draw()
+		double frame = 1e30, end = 1e30;
+		for (int run = 0; run < (compact ? 10 : 3); ++run) {
+			engine.ClearDecals();
+			const auto start = std::chrono::steady_clock::now();
+			batch.Begin();
+			for (int n = 0; n < count; ++n) {
+				batch.Draw(&sprites[n & 3], positions[n], olc::vf2d(32.0f, 32.0f), depths[n]);
+			}
+			const auto drawn = std::chrono::steady_clock::now();
+			batch.End();
+			const auto ended = std::chrono::steady_clock::now();
+			frame = std::min(frame, std::chrono::duration<double, std::milli>(ended - start).count());
+			end = std::min(end, std::chrono::duration<double, std::milli>(ended - drawn).count());
+		}
+		printf("  %-8s %8.2f ms per frame, End() %.2f ms, %zu decals\n",
+			compact ? "compact" : "list", frame, end, engine.Decals().size());
+	}
+	return 0;
+}
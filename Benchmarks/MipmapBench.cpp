@@ -0,0 +1,66 @@
+/*
+	MipmapBench.cpp
+
+	Renderable::SetMipmaps() in the software renderer: 64 different
+	512x512 images drawn at 0.25x into a 640x480 target, with and without
+	mipmaps. Prints the time per frame, best of 20, and the size of the 
+	texture levels sampled in a frame.
+
+	g++ -std=c++14 -O2 MipmapBench.cpp -o MipmapBench -lX11 -lGL -lpng -lpthread -lstdc++fs
+*/
+#define OLC_PGE_APPLICATION
+#include "../pge/olcPixelGameEngine.h"
+#define OLC_PGEX_RENDERBATCH
+#include "../RenderBatch.h"
+#include "NullRenderer.h"
+
+#include <cstdio>
+#include <random>
+
+int main()
+{
+	BenchEngine engine;
+	const int count = 64;
+	const int size = 512;
+	const float scale = 0.25f;
+
+	printf("%d x %dx%d images at %.2fx, software renderer\n", count, size, size, scale);
+	for (int mipmaps = 0; mipmaps < 2; ++mipmaps) {
+		std::mt19937 rng(1);
+		std::vector<olc::Renderable> images(count);
+		for (auto& image : images) {
+			image.SetMipmaps(mipmaps != 0);
+			std::unique_ptr<olc::Sprite> sprite(new olc::Sprite(size, size));
+			for (auto& pixel : sprite->pColData) {
+				pixel.n = rng() | 0xFF000000;
+			}
+			image.Create(std::move(sprite));
+		}
+
+		olc::Sprite target(640, 480);
+		olc::RenderBatch batch(olc::RenderBatch::DrawOrder::Z_INC);
+		batch.SetTarget(&target);
+		const double ms = BestOf(20, [&]() {
+			batch.Begin();
+			for (int n = 0; n < count; ++n) {
+				batch.Draw(&images[n], olc::vf2d(float((n % 8) * 80), float((n / 8) * 60)), scale, 0.5f);
+			}
+			batch.End();
+		});
+
+		// RenderBatch samples the smallest level which is still at least
+		// the size on the screen
+		size_t bytes = 0;
+		for (auto& image : images) {
+			int32_t level = 0;
+			while (level + 1 < image.MipLevels() && image.Mip(level + 1)->Sprite()->width >= size * scale) {
+				++level;
+			}
+			const olc::Sprite* sprite = image.Mip(level)->Sprite();
+			bytes += (size_t)sprite->width * sprite->height * sizeof(olc::Pixel);
+		}
+		printf("  mipmaps %-3s %6.2f ms per frame, %6zu KB of texture sampled\n",
+			mipmaps ? "on" : "off", ms, bytes / 1024);
+	}
+	return 0;
+}
@@ -0,0 +1,77 @@
+/*
+	NullRenderer.h
+
+	A PixelGameEngine renderer which does nothing, for the benchmarks in 
+	this directory. They run without a window or a GPU, the decals drawn
+	are left in the layers where the benchmark can count or inspect them.
+
+	Include after olcPixelGameEngine.h.
+
+	Author: Erno Pakarinen
+	Email: codesmith.fi@gmail.com
+*/
+#ifndef __NULLRENDERER_H_DEFINED__
+#define __NULLRENDERER_H_DEFINED__
+
+#include <chrono>
+#include <algorithm>
+
+class NullRenderer : public olc::Renderer
+{
+public:
+	void PrepareDevice() override { }
+	olc::rcode CreateDevice(std::vector<void*>, bool, bool) override { return olc::rcode::OK; }
+	olc::rcode DestroyDevice() override { return olc::rcode::OK; }
+	void DisplayFrame() override { }
+	void PrepareDrawing() override { }
+	void SetDecalMode(const olc::DecalMode&) override { }
+	void DrawLayerQuad(const olc::vf2d&, const olc::vf2d&, const olc::Pixel) override { }
+	void DrawDecal(const olc::DecalInstance&) override { }
+	uint32_t CreateTexture(const uint32_t, const uint32_t, const bool, const bool) override { return ++m_textures; }
+	void UpdateTexture(uint32_t, olc::Sprite*) override { }
+	void ReadTexture(uint32_t, olc::Sprite*) override { }
+	uint32_t DeleteTexture(const uint32_t _id) override { return _id; }
+	void ApplyTexture(uint32_t) override { }
+	void UpdateViewport(const olc::vi2d&, const olc::vi2d&) override { }
+	void ClearBuffer(olc::Pixel, bool) override { }
+
+private:
+	uint32_t m_textures = 0;
+};
+
+/// An engine with a NullRenderer and the screen layer, which is never
+/// started. RenderBatch and the decal functions work as usual.
+class BenchEngine : public olc::PixelGameEngine
+{
+public:
+	BenchEngine(int32_t _width = 640, int32_t _height = 480)
+	{
+		// The PGE constructor installs the renderer of the platform
+		olc::renderer.reset(new NullRenderer());
+		Construct(_width, _height, 1, 1);
+		CreateLayer();
+	}
+
+	bool OnUserCreate() override { return true; }
+	bool OnUserUpdate(float) override { return true; }
+
+	/// Decals drawn since the last ClearDecals()
+	inline std::vector<olc::DecalInstance>& Decals() { return GetLayers()[0].vecDecalInstance; }
+	inline void ClearDecals() { Decals().clear(); }
+};
+
+/// Best wall time of _runs calls of _function in milliseconds
+template<class Function>
+double BestOf(int _runs, Function _function)
+{
+	double best = 1e30;
+	for (int run = 0; run < _runs; ++run) {
+		const auto start = std::chrono::steady_clock::now();
+		_function();
+		const auto end = std::chrono::steady_clock::now();
+		best = std::min(best, std::chrono::duration<double, std::milli>(end - start).count());
+	}
+	return best;
+}
+
+#endif // __NULLRENDERER_H_DEFINED__
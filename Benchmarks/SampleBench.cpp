@@ -0,0 +1,107 @@
+/*
+	SampleBench.cpp
+
+	Checks the batched olc::Sprite::SampleBL(uv, out, count) and times it
+	against one SampleBL(u, v) call per sample, on 1M random coordinates
+	in -1.5 .. 2.5 in both NORMAL (clamped) and PERIODIC (wrapped) mode.
+	The SSE2 path samples two at a time, so a call with a count of one
+	runs the scalar path, and both must give the same pixels. Both are
+	also compared with bilinear sampling in double precision. Returns 1
+	if the paths differ or the error is over the tolerance.
+
+	g++ -std=c++14 -O2 SampleBench.cpp -o SampleBench -lX11 -lGL -lpng -lpthread -lstdc++fs
+*/
+#define OLC_PGE_APPLICATION
+#include "../pge/olcPixelGameEngine.h"
+#include "NullRenderer.h"
+
+#include <cstdio>
+#include <random>
+#include <cmath>
+
+// Largest channel error allowed against double precision, the weights
+// have 8 bits
+static const int KTolerance = 3;
+
+// Bilinear sample in double precision, clamped or wrapped at the edges
+static olc::Pixel reference(const olc::Sprite& _sprite, float _u, float _v, bool _wrap)
+{
+	auto texel = [&](int _x, int _y) {
+		if (_wrap) {
+			_x %= _sprite.width; if (_x < 0) _x += _sprite.width;
+			_y %= _sprite.height; if (_y < 0) _y += _sprite.height;
+		}
+		else {
+			_x = std::min(std::max(_x, 0), _sprite.width - 1);
+			_y = std::min(std::max(_y, 0), _sprite.height - 1);
+		}
+		return _sprite.pColData[(size_t)_y * _sprite.width + _x];
+	};
+	const double fu = (double)_u * _sprite.width - 0.5;
+	const double fv = (double)_v * _sprite.height - 0.5;
+	const int x = (int)std::floor(fu);
+	const int y = (int)std::floor(fv);
+	const double a = fu - x;
+	const double b = fv - y;
+	const olc::Pixel p[4] = { texel(x, y), texel(x + 1, y), texel(x, y + 1), texel(x + 1, y + 1) };
+	uint8_t out[4];
+	for (int c = 0; c < 4; ++c) {
+		auto channel = [c](const olc::Pixel& _p) { return (double)(c == 0 ? _p.r : c == 1 ? _p.g : c == 2 ? _p.b : _p.a); };
+		const double value = (channel(p[0]) * (1.0 - a) + channel(p[1]) * a) * (1.0 - b) +
+			(channel(p[2]) * (1.0 - a) + channel(p[3]) * a) * b;
+		out[c] = (uint8_t)std::lround(value);
+	}
+	return olc::Pixel(out[0], out[1], out[2], out[3]);
+}
+
+int main()
+{
+	const size_t count = 1 << 20;
+	std::mt19937 rng(3);
+	std::uniform_int_distribution<int> byte(0, 255);
+	std::uniform_real_distribution<float> coordinate(-1.5f, 2.5f);
+
+	olc::Sprite sprite(61, 47);
+	for (auto& pixel : sprite.pColData) {
+		pixel = olc::Pixel(byte(rng), byte(rng), byte(rng), byte(rng));
+	}
+	std::vector<olc::vf2d> uv(count);
+	for (auto& c : uv) {
+		c = { coordinate(rng), coordinate(rng) };
+	}
+
+	bool ok = true;
+	const olc::Sprite::Mode modes[2] = { olc::Sprite::Mode::NORMAL, olc::Sprite::Mode::PERIODIC };
+	for (const olc::Sprite::Mode mode : modes) {
+		const bool wrap = mode == olc::Sprite::Mode::PERIODIC;
+		sprite.SetSampleMode(mode);
+
+		std::vector<olc::Pixel> batched(count), single(count), perCall(count);
+		const double batchedMs = BestOf(5, [&]() { sprite.SampleBL(uv.data(), batched.data(), count); });
+		for (size_t i = 0; i < count; ++i) {
+			sprite.SampleBL(&uv[i], &single[i], 1);
+		}
+		const double perCallMs = BestOf(5, [&]() {
+			for (size_t i = 0; i < count; ++i) {
+				perCall[i] = sprite.SampleBL(uv[i].x, uv[i].y);
+			}
+		});
+
+		size_t differ = 0;
+		int largest = 0;
+		for (size_t i = 0; i < count; ++i) {
+			const olc::Pixel a = batched[i], b = reference(sprite, uv[i].x, uv[i].y, wrap);
+			differ += a != single[i] ? 1 : 0;
+			largest = std::max(largest, std::max(std::max(std::abs(a.r - b.r), std::abs(a.g - b.g)),
+				std::max(std::abs(a.b - b.b), std::abs(a.a - b.a))));
+		}
+		ok = ok && differ == 0 && largest <= KTolerance;
+
+		printf("%s, %zu samples of a %dx%d sprite\n", wrap ? "PERIODIC" : "NORMAL", count, sprite.width, sprite.height);
+		printf("  SampleBL(uv, out, count)  %7.2f ms\n", batchedMs);
+		printf("  SampleBL(u, v) per call   %7.2f ms\n", perCallMs);
+		printf("  %zu samples differ between the SSE2 and the scalar path\n", differ);
+		printf("  largest channel error %d against double precision\n", largest);
+	}
+	return ok ? 0 : 1;
+}
@@ -0,0 +1,225 @@
+/*
+	SoftwareCompare.cpp
+
+	Checks the software renderer of RenderBatch (SetTarget()) against the
+	GPU path. The same batch of 60 random entries, all blend modes, 
+	rotations, flips and tints, is drawn twice: once into a sprite, and
+	once as decals. The decals are then rasterized in floating point 
+	the way OpenGL draws them: pixel centres inside the two triangles of
+	each quad, interpolated texture coordinates, nearest or bilinear
+	sampling and the glBlendFunc() of the DecalMode. Prints the largest
+	channel difference and returns 1 if it is over the tolerance, so it 
+	can be used as a test.
+
+	Both paths are then drawn again with occlusion culling, which must 
+	not change the picture. Opaque mirrored entries (negative scale) on
+	top check that culling sees their real bounds.
+
+	There is no GPU here, so the reference is not the real driver, but 
+	it follows the decals RenderBatch actually emits.
+
+	g++ -std=c++14 -O2 SoftwareCompare.cpp -o SoftwareCompare -lX11 -lGL -lpng -lpthread -lstdc++fs
+*/
+#define OLC_PGE_APPLICATION
+#include "../pge/olcPixelGameEngine.h"
+#define OLC_PGEX_RENDERBATCH
+#include "../RenderBatch.h"
+#include "NullRenderer.h"
+
+#include <cstdio>
+#include <random>
+#include <cmath>
+
+// Largest channel difference allowed, the software renderer works in 
+// 8 bit fixed point
+static const int KTolerance = 4;
+
+// GL_NEAREST or GL_LINEAR with GL_CLAMP_TO_EDGE, channels in 0-255
+static void sample(const olc::Sprite* _sprite, float _u, float _v, bool _bilinear, float* _out)
+{
+	auto texel = [_sprite](int _x, int _y) {
+		_x = std::min(std::max(_x, 0), _sprite->width - 1);
+		_y = std::min(std::max(_y, 0), _sprite->height - 1);
+		return _sprite->pColData[(size_t)_y * _sprite->width + _x];
+	};
+	if (!_bilinear) {
+		const olc::Pixel p = texel((int)std::floor(_u * _sprite->width), (int)std::floor(_v * _sprite->height));
+		_out[0] = p.r; _out[1] = p.g; _out[2] = p.b; _out[3] = p.a;
+		return;
+	}
+	const float fu = _u * _sprite->width - 0.5f;
+	const float fv = _v * _sprite->height - 0.5f;
+	const int x = (int)std::floor(fu);
+	const int y = (int)std::floor(fv);
+	const float a = fu - x;
+	const float b = fv - y;
+	const olc::Pixel p[4] = { texel(x, y), texel(x + 1, y), texel(x, y + 1), texel(x + 1, y + 1) };
+	for (int c = 0; c < 4; ++c) {
+		auto channel = [c](const olc::Pixel& _p) { return (float)(c == 0 ? _p.r : c == 1 ? _p.g : c == 2 ? _p.b : _p.a); };
+		_out[c] = (channel(p[0]) * (1.0f - a) + channel(p[1]) * a) * (1.0f - b) + 
+			(channel(p[2]) * (1.0f - a) + channel(p[3]) * a) * b;
+	}
+}
+
+// Draws one decal into _target as OpenGL would
+static void drawDecal(const olc::DecalInstance& _decal, olc::Sprite* _target, bool _bilinear)
+{
+	const float w = (float)_target->width;
+	const float h = (float)_target->height;
+	olc::vf2d p[4];
+	for (int n = 0; n < 4; ++n) {
+		p[n] = { (_decal.pos[n].x + 1.0f) * 0.5f * w, (1.0f - _decal.pos[n].y) * 0.5f * h };
+	}
+	const olc::Pixel tint = _decal.tint[0];
+	const float tints[4] = { (float)tint.r, (float)tint.g, (float)tint.b, (float)tint.a };
+
+	// Triangle fan 0 1 2, 0 2 3. Pixels are given to one of the two by
+	// their side of the diagonal 0 2, so the shared edge is drawn once
+	const int triangles[2][3] = { { 0, 1, 2 }, { 0, 2, 3 } };
+	auto side = [&p](float _x, float _y) { return (p[2].x - p[0].x) * (_y - p[0].y) - (p[2].y - p[0].y) * (_x - p[0].x); };
+	const bool firstPositive = side(p[1].x, p[1].y) > 0.0f;
+	for (int y = 0; y < _target->height; ++y) {
+		for (int x = 0; x < _target->width; ++x) {
+			const float px = x + 0.5f, py = y + 0.5f;
+			const bool first = (side(px, py) > 0.0f) == firstPositive;
+			const int* t = triangles[first ? 0 : 1];
+			const olc::vf2d a = p[t[0]], b = p[t[1]], c = p[t[2]];
+			const float area = (b.x - a.x) * (c.y - a.y) - (b.y - a.y) * (c.x - a.x);
+			if (std::fabs(area) < 1e-6f) {
+				continue;
+			}
+			const float w0 = ((b.x - px) * (c.y - py) - (b.y - py) * (c.x - px)) / area;
+			const float w1 = ((c.x - px) * (a.y - py) - (c.y - py) * (a.x - px)) / area;
+			const float w2 = 1.0f - w0 - w1;
+			// The weight of the vertex opposite the diagonal is not checked,
+			// the side test above decided it
+			if (w0 < 0.0f || (first ? w2 : w1) < 0.0f) {
+				continue;
+			}
+			const float u = w0 * _decal.uv[t[0]].x + w1 * _decal.uv[t[1]].x + w2 * _decal.uv[t[2]].x;
+			const float v = w0 * _decal.uv[t[0]].y + w1 * _decal.uv[t[1]].y + w2 * _decal.uv[t[2]].y;
+			float s[4];
+			sample(_decal.decal->sprite, u, v, _bilinear, s);
+			olc::Pixel& dst = _target->pColData[(size_t)y * _target->width + x];
+			const float d[4] = { (float)dst.r, (float)dst.g, (float)dst.b, (float)dst.a };
+			for (int ch = 0; ch < 4; ++ch) {
+				s[ch] = s[ch] * tints[ch] / 255.0f;
+			}
+			const float alpha = s[3] / 255.0f;
+			float o[4];
+			for (int ch = 0; ch < 4; ++ch) {
+				switch (_decal.mode) {
+				case olc::DecalMode::ADDITIVE: o[ch] = s[ch] * alpha + d[ch]; break;
+				case olc::DecalMode::MULTIPLICATIVE: o[ch] = s[ch] * d[ch] / 255.0f + d[ch] * (1.0f - alpha); break;
+				case olc::DecalMode::STENCIL: o[ch] = d[ch] * alpha; break;
+				case olc::DecalMode::ILLUMINATE: o[ch] = s[ch] * (1.0f - alpha) + d[ch] * alpha; break;
+				default: o[ch] = s[ch] * alpha + d[ch] * (1.0f - alpha); break;
+				}
+				o[ch] = std::min(std::max(o[ch], 0.0f), 255.0f) + 0.5f;
+			}
+			dst = olc::Pixel((uint8_t)o[0], (uint8_t)o[1], (uint8_t)o[2], (uint8_t)o[3]);
+		}
+	}
+}
+
+// Largest channel difference of two images, and the pixels over KTolerance
+static int compare(const olc::Sprite& _a, const olc::Sprite& _b, int* _over)
+{
+	int largest = 0;
+	*_over = 0;
+	for (size_t i = 0; i < _a.pColData.size(); ++i) {
+		const olc::Pixel a = _a.pColData[i], b = _b.pColData[i];
+		const int diff = std::max(std::max(std::abs(a.r - b.r), std::abs(a.g - b.g)), 
+			std::max(std::abs(a.b - b.b), std::abs(a.a - b.a)));
+		largest = std::max(largest, diff);
+		*_over += diff > KTolerance ? 1 : 0;
+	}
+	return largest;
+}
+
+int main()
+{
+	const int width = 320, height = 240;
+	BenchEngine engine(width, height);
+	const olc::DecalMode modes[5] = { olc::DecalMode::NORMAL, olc::DecalMode::ADDITIVE,
+		olc::DecalMode::MULTIPLICATIVE, olc::DecalMode::STENCIL, olc::DecalMode::ILLUMINATE };
+	const int sizes[3][2] = { { 16, 16 }, { 7, 13 }, { 32, 20 } };
+	int worst = 0;
+
+	for (int bilinear = 0; bilinear < 2; ++bilinear) {
+		std::mt19937 rng(7);
+		std::uniform_int_distribution<int> byte(0, 255);
+		std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+
+		// The texture filter of the decals has to match the software filter
+		olc::Renderable images[3];
+		for (int k = 0; k < 3; ++k) {
+			std::unique_ptr<olc::Sprite> sprite(new olc::Sprite(sizes[k][0], sizes[k][1]));
+			for (auto& pixel : sprite->pColData) {
+				pixel = olc::Pixel(byte(rng), byte(rng), byte(rng), k == 0 ? 255 : byte(rng));
+			}
+			images[k].Create(std::move(sprite), bilinear != 0);
+		}
+
+		olc::RenderBatch batch(olc::RenderBatch::DrawOrder::UNORDERED);
+		batch.SetFilter(bilinear ? olc::RenderBatch::Filter::BILINEAR : olc::RenderBatch::Filter::NEAREST);
+		auto draw = [&](std::mt19937 _rng) {
+			batch.Begin();
+			for (int i = 0; i < 60; ++i) {
+				const int k = i % 3;
+				const olc::vf2d pos(unit(_rng) * (width + 20) - 10.0f, unit(_rng) * (height + 20) - 10.0f);
+				const float scale = 0.5f + unit(_rng) * 3.0f;
+				const olc::vf2d scales(scale, scale * (0.5f + unit(_rng)));
+				const float angle = unit(_rng) * 6.28f;
+				const olc::vf2d origin(unit(_rng) * sizes[k][0], unit(_rng) * sizes[k][1]);
+				const olc::Pixel tint = i % 4 == 0 ? olc::WHITE : olc::Pixel(byte(_rng), byte(_rng), byte(_rng), byte(_rng));
+				if (i % 2) {
+					batch.Draw(&images[k], pos, scales, angle, origin, 0.5f, (uint8_t)((i / 2) % 4), tint, modes[i % 5]);
+				}
+				else {
+					batch.Draw(&images[k], pos, olc::vf2d(sizes[k][0] * scales.x, sizes[k][1] * scales.y), 0.5f, tint, modes[i % 5]);
+				}
+			}
+			// Mirrored opaque entries, by a negative scale and by negative sizes
+			const olc::vf2d size0((float)sizes[0][0], (float)sizes[0][1]);
+			batch.Draw(&images[0], olc::vf2d(width * 0.3f, height * 0.2f), -4.0f, 0.5f);
+			batch.Draw(&images[0], olc::vf2d(width * 0.5f, height * 0.6f), olc::vf2d(-size0.x * 5.0f, size0.y * 3.0f), 0.5f);
+			batch.Draw(&images[0], olc::vf2d(width * 0.8f, height * 0.9f), olc::vf2d(size0.x * 3.0f, -size0.y * 5.0f), 0.5f);
+			batch.End();
+		};
+
+		// Draws the batch in software into _software, and as decals
+		// rasterized like OpenGL into _reference
+		auto render = [&](olc::Sprite* _software, olc::Sprite* _reference, bool _culling) {
+			for (auto& pixel : _software->pColData) {
+				pixel = olc::Pixel(40, 80, 120, 255);
+			}
+			_reference->pColData = _software->pColData;
+			batch.SetOcclusionCulling(_culling);
+			batch.SetTarget(_software);
+			draw(rng);
+			batch.SetTarget(nullptr);
+			engine.ClearDecals();
+			draw(rng);
+			for (const auto& decal : engine.Decals()) {
+				drawDecal(decal, _reference, bilinear != 0);
+			}
+		};
+		const char* name = bilinear ? "bilinear" : "nearest";
+
+		olc::Sprite software(width, height), reference(width, height);
+		render(&software, &reference, false);
+		int over = 0;
+		int largest = compare(software, reference, &over);
+		printf("%-8s largest channel difference %d, %d pixels over %d\n", name, largest, over, KTolerance);
+		worst = std::max(worst, largest);
+
+		olc::Sprite softwareCulled(width, height), referenceCulled(width, height);
+		render(&softwareCulled, &referenceCulled, true);
+		largest = std::max(compare(software, softwareCulled, &over), compare(reference, referenceCulled, &over));
+		printf("%-8s with occlusion culling, largest channel difference %d, %d entries culled\n", 
+			name, largest, (int)batch.GetStats().culled);
+		worst = std::max(worst, largest);
+	}
+	return worst <= KTolerance ? 0 : 1;
+}
@@ -14,6 +14,48 @@
   *		LOG_WARN() << "You failed " << 20 << "Times!"
   *		LOG_ERROR() << "You failed " << 20 << "Times!"
   *
+  * Deferred formatting, "{}" is replaced by the next argument:
+  *		LOGF_INFO("You failed {} times!", 20)
+  *		LOGF_WARN("You failed {} times!", 20)
+  *		LOGF_ERROR("You failed {} times!", 20)
+  *
+  * These store the format string pointer and the raw argument values. The
+  * text is only made when the message is written, by the writer thread in
+  * asynchronous mode, so they do not allocate or format anything on the
+  * calling thread. Arguments can be numbers, bool, char, strings and
+  * pointers.
+  *
+  * Rate limited, for code which runs every frame or more often:
+  *		LOG_WARN_EVERY_N(1000) << "Renderable is null"
+  *		LOG_WARN_EVERY_MS(1000) << "Renderable is null"
+  *		LOG_WARN_ONCE() << "Renderable is null"
+  *		LOGF_WARN_EVERY_MS(1000, "Renderable {} is null", index)
+  *
+  * Each call site counts the messages it skips, and the next message it
+  * writes ends with "(N similar messages suppressed)". There are INFO,
+  * WARN and ERROR variants of each, LOG_ONCE() is ERROR like LOG().
+  *
+  * Messages below DEBUGLOGGER_MIN_LEVEL (0 INFO, 1 WARN, 2 ERROR, 3 none)
+  * are removed at compile time, their arguments are not evaluated. Release
+  * builds (NDEBUG) default to 1, so LOG_INFO() compiles to nothing.
+  *
+  * Time stamps are local time with milliseconds, "[2021-05-25 18:30:01.250]".
+  * They are taken from std::chrono::steady_clock, so they never go back
+  * when the system clock is adjusted, and the date part is formatted only
+  * once per second per thread.
+  *
+  * Asynchronous output:
+  *		DebugLogger::StartAsync();
+  *		...
+  *		DebugLogger::StopAsync();
+  *
+  * Between these the messages are put into a preallocated ring buffer and
+  * a background thread adds the time stamps and writes them to std::cerr,
+  * so logging from the game loop does not wait for the console.
+  * StopAsync() writes everything still in the buffer, it is also called
+  * when the program exits. Flush() waits until all messages logged so far
+  * have been written.
+  *
   * Author: Erno Pakarinen
   * Email: codesmith.fi@gmail.com
   * Date: 25th of May 2021
@@ -25,10 +67,32 @@
 #define __DEBUGLOGGER_DEFINED_H__
 
 #include <iostream>
-#include <iomanip>
 #include <sstream>
 #include <chrono>
 #include <ctime>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <memory>
+#include <string>
+#include <cstring>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <type_traits>
+#if defined(__linux__)
+#include <time.h>
+#endif
+
+#if !defined(DEBUGLOGGER_MIN_LEVEL)
+	#if defined(NDEBUG)
+		#define DEBUGLOGGER_MIN_LEVEL 1
+	#else
+		#define DEBUGLOGGER_MIN_LEVEL 0
+	#endif
+#endif
 
 namespace codesmith
 {
@@ -45,6 +109,589 @@ namespace codesmith
 			EERROR = 2
 		};
 
+		/**
+		 * What the asynchronous logger does when its ring buffer is full
+		 * EDROP: the message is dropped and counted, the writer thread
+		 *        reports the count
+		 * EBLOCK: the logging thread waits until there is room
+		 */
+		enum class LogOverflow : int
+		{
+			EDROP = 0,
+			EBLOCK = 1
+		};
+
+		/**
+		 * Time stamps of the messages. They are taken from the monotonic
+		 * steady_clock, so the order and the differences of the time stamps
+		 * are right even if the system time changes, and are shown as local
+		 * time using the offset between the two clocks at the first use.
+		 */
+		class LogClock
+		{
+		public:
+			typedef std::chrono::steady_clock::time_point TimePoint;
+
+			static inline TimePoint Now() {
+				return std::chrono::steady_clock::now();
+			}
+
+			/**
+			 * Milliseconds of a monotonic clock. The coarse clock on Linux
+			 * is updated every tick but costs a few nanoseconds instead of
+			 * tens, which matters when a call site is hit 100k times a frame.
+			 */
+			static inline uint64_t CoarseMs() {
+#if defined(__linux__) && defined(CLOCK_MONOTONIC_COARSE)
+				struct timespec ts;
+				clock_gettime(CLOCK_MONOTONIC_COARSE, &ts);
+				return (uint64_t)ts.tv_sec * 1000 + (uint64_t)ts.tv_nsec / 1000000;
+#else
+				return (uint64_t)std::chrono::duration_cast<std::chrono::milliseconds>(
+					std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+			}
+
+			/**
+			 * Appends time as "YYYY-MM-DD HH:MM:SS.mmm" local time. The date
+			 * and time part is cached per thread and only made again when 
+			 * the second changes, the milliseconds are three digits added
+			 * to it.
+			 */
+			static void Append(std::string& out, const TimePoint& time) {
+				struct Cache {
+					int64_t second = INT64_MIN;
+					char text[32];
+					size_t length = 0;
+				};
+				thread_local Cache cache;
+
+				const int64_t ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+					time.time_since_epoch()).count() + wallOffsetMs();
+				// Rounds down for times before 1970 too
+				const int64_t second = (ms >= 0 ? ms : ms - 999) / 1000;
+				const int millis = (int)(ms - second * 1000);
+				if (second != cache.second) {
+					struct std::tm stm{};
+					LocalTime((std::time_t)second, stm);
+					cache.length = std::strftime(cache.text, sizeof(cache.text), "%F %T", &stm);
+					cache.second = second;
+				}
+				const char digits[4] = { '.', (char)('0' + millis / 100), (char)('0' + millis / 10 % 10), (char)('0' + millis % 10) };
+				out.append(cache.text, cache.length);
+				out.append(digits, 4);
+			}
+
+			/// localtime() which is thread safe on every platform
+			static inline void LocalTime(std::time_t time, struct std::tm& stm) {
+#if defined(_WIN32)
+				localtime_s(&stm, &time);
+#else
+				localtime_r(&time, &stm);
+#endif
+			}
+
+		private:
+			/** System time minus steady_clock time in milliseconds, measured once */
+			static int64_t wallOffsetMs() {
+				static const int64_t offset =
+					std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count() -
+					std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+				return offset;
+			}
+		};
+
+		/**
+		 * State of one rate limited call site. The checks only use relaxed
+		 * atomics, so the call site can be hit from any number of threads.
+		 * suppressed is set to the number of messages skipped since the 
+		 * last one which was let through.
+		 */
+		class LogLimiter
+		{
+		public:
+			/// Lets through the 1st, n+1th, 2n+1th... message
+			inline bool EveryN(uint64_t n, uint64_t& suppressed) {
+				const uint64_t count = m_count.fetch_add(1, std::memory_order_relaxed);
+				if (n > 1 && count % n != 0) {
+					return false;
+				}
+				suppressed = count == 0 || n <= 1 ? 0 : n - 1;
+				return true;
+			}
+
+			/// Lets through at most one message every ms milliseconds
+			inline bool EveryMs(uint64_t ms, uint64_t& suppressed) {
+				const uint64_t now = LogClock::CoarseMs();
+				uint64_t next = m_next.load(std::memory_order_relaxed);
+				if (now < next || !m_next.compare_exchange_strong(next, now + ms, std::memory_order_relaxed)) {
+					m_count.fetch_add(1, std::memory_order_relaxed);
+					return false;
+				}
+				suppressed = m_count.exchange(0, std::memory_order_relaxed);
+				return true;
+			}
+
+			/// Lets through the first message only
+			inline bool Once(uint64_t& suppressed) {
+				suppressed = 0;
+				return m_count.load(std::memory_order_relaxed) == 0 &&
+					m_count.exchange(1, std::memory_order_relaxed) == 0;
+			}
+
+		private:
+			std::atomic<uint64_t> m_count{ 0 };
+			std::atomic<uint64_t> m_next{ 0 };
+		};
+
+		/**
+		 * Writes the arguments of a LOGF_*() message as a type tag followed
+		 * by the raw value. Integers take 8 bytes, strings are copied with a
+		 * 16 bit length. Arguments which do not fit are left out, their
+		 * placeholders are kept.
+		 */
+		class LogArgs
+		{
+		public: // types
+			enum class ArgType : uint8_t
+			{
+				EINT = 0,
+				EUINT = 1,
+				EDOUBLE = 2,
+				EBOOL = 3,
+				ECHAR = 4,
+				ESTRING = 5,
+				EPOINTER = 6
+			};
+
+		public:
+			LogArgs(char* data, size_t capacity) : m_data(data), m_capacity(capacity) { }
+
+			inline size_t Size() const { return m_size; }
+
+			template <typename T, typename... Args>
+			inline void Add(const T& value, const Args&... args) {
+				put(value);
+				Add(args...);
+			}
+			inline void Add() { }
+
+			/**
+			 * Appends format to out with every "{}" replaced by the next
+			 * argument in data. Placeholders without an argument are kept.
+			 */
+			static void Format(std::string& out, const char* format, const char* data, size_t size) {
+				size_t pos = 0;
+				const char* text = format;
+				while (*text != 0) {
+					if (text[0] != '{' || text[1] != '}' || pos >= size) {
+						out += *text++;
+						continue;
+					}
+					text += 2;
+					pos = decode(out, data, pos);
+				}
+			}
+
+		private:
+			inline void put(bool value) { raw(ArgType::EBOOL, &value, 1); }
+			inline void put(char value) { raw(ArgType::ECHAR, &value, 1); }
+			inline void put(float value) { put((double)value); }
+			inline void put(double value) { raw(ArgType::EDOUBLE, &value, sizeof(value)); }
+			inline void put(long double value) { put((double)value); }
+			inline void put(const char* value) { string(value != nullptr ? value : "(null)", value != nullptr ? std::strlen(value) : 6); }
+			inline void put(char* value) { put((const char*)value); }
+			inline void put(const std::string& value) { string(value.data(), value.size()); }
+			template <typename T>
+			inline void put(const T* value) { raw(ArgType::EPOINTER, &value, sizeof(value)); }
+			template <typename T>
+			inline typename std::enable_if<std::is_integral<T>::value>::type put(const T& value) {
+				if (std::is_signed<T>::value) {
+					const int64_t wide = (int64_t)value;
+					raw(ArgType::EINT, &wide, sizeof(wide));
+				}
+				else {
+					const uint64_t wide = (uint64_t)value;
+					raw(ArgType::EUINT, &wide, sizeof(wide));
+				}
+			}
+
+			inline void raw(ArgType type, const void* value, size_t size) {
+				if (m_full || m_size + 1 + size > m_capacity) {
+					m_full = true;
+					return;
+				}
+				m_data[m_size] = (char)type;
+				std::memcpy(m_data + m_size + 1, value, size);
+				m_size += 1 + size;
+			}
+
+			inline void string(const char* value, size_t length) {
+				if (m_full || m_size + 3 > m_capacity) {
+					m_full = true;
+					return;
+				}
+				// Cut to the space left
+				const uint16_t stored = (uint16_t)std::min(length, m_capacity - m_size - 3);
+				m_data[m_size] = (char)ArgType::ESTRING;
+				std::memcpy(m_data + m_size + 1, &stored, 2);
+				std::memcpy(m_data + m_size + 3, value, stored);
+				m_size += 3 + stored;
+			}
+
+			/**
+			 * Appends the argument at data + pos as text, returns the position
+			 * of the next one
+			 */
+			static size_t decode(std::string& out, const char* data, size_t pos) {
+				char text[32];
+				int length = 0;
+				const char* value = data + pos + 1;
+				switch ((ArgType)data[pos]) {
+					case ArgType::EINT:
+					{
+						int64_t v;
+						std::memcpy(&v, value, sizeof(v));
+						length = std::snprintf(text, sizeof(text), "%lld", (long long)v);
+						pos += 1 + sizeof(v);
+						break;
+					}
+					case ArgType::EUINT:
+					{
+						uint64_t v;
+						std::memcpy(&v, value, sizeof(v));
+						length = std::snprintf(text, sizeof(text), "%llu", (unsigned long long)v);
+						pos += 1 + sizeof(v);
+						break;
+					}
+					case ArgType::EDOUBLE:
+					{
+						// Same as the default std::ostream output
+						double v;
+						std::memcpy(&v, value, sizeof(v));
+						length = std::snprintf(text, sizeof(text), "%g", v);
+						pos += 1 + sizeof(v);
+						break;
+					}
+					case ArgType::EBOOL:
+					{
+						out += *value != 0 ? "true" : "false";
+						pos += 2;
+						break;
+					}
+					case ArgType::ECHAR:
+					{
+						out += *value;
+						pos += 2;
+						break;
+					}
+					case ArgType::ESTRING:
+					{
+						uint16_t stored;
+						std::memcpy(&stored, value, 2);
+						out.append(value + 2, stored);
+						pos += 3 + stored;
+						break;
+					}
+					case ArgType::EPOINTER:
+					{
+						const void* v;
+						std::memcpy(&v, value, sizeof(v));
+						length = std::snprintf(text, sizeof(text), "%p", v);
+						pos += 1 + sizeof(v);
+						break;
+					}
+				}
+				if (length > 0) {
+					out.append(text, (size_t)length);
+				}
+				return pos;
+			}
+
+		private:
+			char* m_data;
+			size_t m_capacity;
+			size_t m_size = 0;
+			// Later arguments are dropped too, so the rest keep their places
+			bool m_full = false;
+		};
+
+		/**
+		 * Bounded multi producer, single consumer ring buffer of log records
+		 * and the thread writing them. Producers claim a slot with one
+		 * compare and swap and publish it with a sequence number, so logging
+		 * threads never take a lock, they only signal the condition variable
+		 * when the writer is asleep. A record holds either the text of a
+		 * message, or for LOGF_*() the format string and the encoded 
+		 * arguments, which the writer thread formats. Used through DebugLogger.
+		 */
+		class AsyncLogWriter
+		{
+		public: // constants
+			// Longer messages are cut, ending with "..."
+			static constexpr size_t KRecordText = 220;
+
+		public:
+			typedef LogClock::TimePoint TimePoint;
+			// format is nullptr for plain text
+			typedef void (*Formatter)(std::string& out, DebugLogLevel severity, bool showtime,
+				const TimePoint& time, const char* format, const char* data, size_t length, uint64_t suppressed);
+
+			/**
+			 * Never destroyed, threads may still log while static objects are
+			 * destructed. The messages are written by an atexit() handler,
+			 * later messages are written directly.
+			 */
+			static AsyncLogWriter& Instance() {
+				static AsyncLogWriter* writer = create();
+				return *writer;
+			}
+
+			/**
+			 * Start the writer thread with room for _capacity messages,
+			 * rounded up to a power of two. Does nothing if already running.
+			 */
+			void Start(Formatter formatter, size_t capacity, LogOverflow policy) {
+				std::lock_guard<std::mutex> lock(m_control);
+				if (m_running.load()) {
+					return;
+				}
+				size_t size = 2;
+				while (size < capacity) {
+					size *= 2;
+				}
+				m_slots.reset(new Slot[size]);
+				m_mask = size - 1;
+				for (size_t i = 0; i < size; ++i) {
+					m_slots[i].sequence.store(i, std::memory_order_relaxed);
+				}
+				m_head.store(0);
+				m_tail = 0;
+				m_written = 0;
+				m_formatter = formatter;
+				m_policy = policy;
+				m_stop = false;
+				m_running.store(true);
+				m_thread = std::thread(&AsyncLogWriter::run, this);
+			}
+
+			/// Write all queued messages and stop the thread
+			void Stop() {
+				std::lock_guard<std::mutex> lock(m_control);
+				if (!m_running.load()) {
+					return;
+				}
+				m_running.store(false);
+				// Messages being pushed right now still make it into the buffer
+				while (m_producers.load() != 0) {
+					std::this_thread::yield();
+				}
+				{
+					std::lock_guard<std::mutex> wake(m_mutex);
+					m_stop = true;
+				}
+				m_wake.notify_one();
+				m_thread.join();
+				m_slots.reset();
+			}
+
+			/// Wait until every message pushed before this call is written
+			void Flush() {
+				if (!m_running.load()) {
+					return;
+				}
+				const size_t target = m_head.load();
+				std::unique_lock<std::mutex> lock(m_mutex);
+				m_wake.notify_one();
+				m_flushed.wait(lock, [&] { return m_written >= target || m_stop; });
+			}
+
+			inline bool Running() const { return m_running.load(std::memory_order_relaxed); }
+
+			/// Messages dropped because the buffer was full, since the last report
+			inline uint64_t Dropped() const { return m_dropped.load(std::memory_order_relaxed); }
+
+			/**
+			 * Queue a text message. Returns false if the writer is not running,
+			 * the caller should then write the message itself.
+			 */
+			bool Push(DebugLogLevel severity, bool showtime, const TimePoint& time, const char* text, size_t length, uint64_t suppressed) {
+				return Emplace(severity, showtime, time, nullptr, suppressed, [&](char* data) {
+					if (length > KRecordText) {
+						std::memcpy(data, text, KRecordText - 3);
+						std::memcpy(data + KRecordText - 3, "...", 3);
+						return KRecordText;
+					}
+					std::memcpy(data, text, length);
+					return length;
+				});
+			}
+
+			/**
+			 * Queue a message whose data is written by fill(char* data) straight
+			 * into the ring buffer, up to KRecordText bytes. fill returns the
+			 * number of bytes written. format is nullptr for text.
+			 */
+			template <typename Fill>
+			bool Emplace(DebugLogLevel severity, bool showtime, const TimePoint& time, const char* format, uint64_t suppressed, Fill fill) {
+				m_producers.fetch_add(1);
+				if (!m_running.load()) {
+					m_producers.fetch_sub(1);
+					return false;
+				}
+				size_t pos = m_head.load(std::memory_order_relaxed);
+				Slot* slot = nullptr;
+				for (;;) {
+					slot = &m_slots[pos & m_mask];
+					const size_t sequence = slot->sequence.load(std::memory_order_acquire);
+					const intptr_t diff = (intptr_t)sequence - (intptr_t)pos;
+					if (diff == 0) {
+						if (m_head.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+							break;
+						}
+					}
+					else if (diff < 0) {
+						// Full, the writer has not consumed this slot yet
+						if (m_policy == LogOverflow::EDROP) {
+							m_dropped.fetch_add(1, std::memory_order_relaxed);
+							m_producers.fetch_sub(1);
+							return true;
+						}
+						wake();
+						std::this_thread::yield();
+						pos = m_head.load(std::memory_order_relaxed);
+					}
+					else {
+						pos = m_head.load(std::memory_order_relaxed);
+					}
+				}
+
+				Record& record = slot->record;
+				record.time = time;
+				record.severity = severity;
+				record.showtime = showtime;
+				record.format = format;
+				record.suppressed = suppressed;
+				record.length = (uint16_t)fill(record.data);
+				slot->sequence.store(pos + 1, std::memory_order_release);
+				m_producers.fetch_sub(1);
+
+				if (m_sleeping.load(std::memory_order_relaxed)) {
+					wake();
+				}
+				return true;
+			}
+
+		private: // types
+			struct Record {
+				TimePoint time;
+				const char* format;
+				uint64_t suppressed;
+				DebugLogLevel severity;
+				bool showtime;
+				uint16_t length;
+				char data[KRecordText];
+			};
+			struct Slot {
+				std::atomic<size_t> sequence;
+				Record record;
+			};
+
+		private:
+			AsyncLogWriter() = default;
+			AsyncLogWriter(const AsyncLogWriter&) = delete;
+			AsyncLogWriter& operator=(const AsyncLogWriter&) = delete;
+
+			static AsyncLogWriter* create() {
+				// Placement new, C++14 operator new does not honour alignas(64)
+				static std::aligned_storage<sizeof(AsyncLogWriter), alignof(AsyncLogWriter)>::type storage;
+				AsyncLogWriter* writer = new (&storage) AsyncLogWriter();
+				std::atexit([] { Instance().Stop(); });
+				return writer;
+			}
+
+			/**
+			 * Wake the writer if it is asleep, without the mutex. A wake up
+			 * lost between the writer's last check and its wait only delays
+			 * the messages until the timed wait in run() ends.
+			 */
+			void wake() {
+				if (m_sleeping.exchange(false)) {
+					m_wake.notify_one();
+				}
+			}
+
+			/**
+			 * Writer thread, formats the messages in batches and writes each
+			 * batch with one call. Sleeps when the buffer is empty, producers
+			 * wake it up.
+			 */
+			void run() {
+				std::string batch;
+				for (;;) {
+					batch.clear();
+					size_t count = 0;
+					for (;;) {
+						Slot& slot = m_slots[m_tail & m_mask];
+						if (slot.sequence.load(std::memory_order_acquire) != m_tail + 1) {
+							break;
+						}
+						const Record& record = slot.record;
+						m_formatter(batch, record.severity, record.showtime, record.time, record.format, record.data, record.length, record.suppressed);
+						slot.sequence.store(m_tail + m_mask + 1, std::memory_order_release);
+						++m_tail;
+						++count;
+					}
+					const uint64_t dropped = m_dropped.exchange(0, std::memory_order_relaxed);
+					if (dropped > 0) {
+						const std::string text = std::to_string(dropped) + " log messages dropped, the buffer was full";
+						m_formatter(batch, DebugLogLevel::EWARN, true, LogClock::Now(), nullptr, text.c_str(), text.size(), 0);
+					}
+					if (!batch.empty()) {
+						std::cerr.write(batch.data(), (std::streamsize)batch.size());
+						std::cerr.flush();
+					}
+
+					std::unique_lock<std::mutex> lock(m_mutex);
+					m_written = m_tail;
+					m_flushed.notify_all();
+					if (count > 0) {
+						continue;
+					}
+					if (m_stop) {
+						break;
+					}
+					// Timed, a producer may publish between the check above and the sleep
+					m_sleeping.store(true);
+					m_wake.wait_for(lock, std::chrono::milliseconds(10));
+					m_sleeping.store(false);
+				}
+			}
+
+		private:
+			std::unique_ptr<Slot[]> m_slots;
+			size_t m_mask = 0;
+			// Next slot to claim, shared by the producers
+			alignas(64) std::atomic<size_t> m_head{ 0 };
+			// Next slot to write, only used by the writer thread
+			alignas(64) size_t m_tail = 0;
+			std::atomic<uint64_t> m_dropped{ 0 };
+			std::atomic<int> m_producers{ 0 };
+			std::atomic<bool> m_running{ false };
+			std::atomic<bool> m_sleeping{ false };
+			LogOverflow m_policy = LogOverflow::EDROP;
+			Formatter m_formatter = nullptr;
+
+			std::mutex m_mutex;
+			std::condition_variable m_wake;
+			std::condition_variable m_flushed;
+			size_t m_written = 0;
+			bool m_stop = false;
+
+			std::mutex m_control;
+			std::thread m_thread;
+		};
+
 		/**
 		 * DebugLogger class definition
 		 * Class has stream output operation with operator <<
@@ -53,7 +700,8 @@ namespace codesmith
 		 * 
 		 * Default warning level is ERROR
 		 * 
-		 * When class instance is destructed
+		 * When class instance is destructed the message is written, or queued
+		 * for the writer thread if StartAsync() has been called.
 		 */
 		class DebugLogger
 		{
@@ -63,37 +711,47 @@ namespace codesmith
 			static constexpr const char* KTextLevelError = "ERROR";
 
 		public:
-			DebugLogger(DebugLogLevel severity = DebugLogLevel::EERROR, bool showtime = true) 
-				: m_buffer(), m_stm{}
-			{				
+			DebugLogger(DebugLogLevel severity = DebugLogLevel::EERROR, bool showtime = true, uint64_t suppressed = 0) 
+				: m_buffer(), m_severity(severity), m_showtime(showtime), m_suppressed(suppressed)
+			{
 				if (showtime) {
-					make_time();
-					m_buffer << "[" << std::put_time(&m_stm, "%F %T") << "] ";
+					m_time = LogClock::Now();
 				}
-
-				switch(severity) {
-					case DebugLogLevel::EWARN:
-					{
-						m_buffer << KTextLevelWarn;
-						break;
-					}
-				case DebugLogLevel::EERROR:
-					{
-						m_buffer << KTextLevelError;
-						break;
-					}
-					default:
-					{
-						m_buffer << KTextLevelInfo;
-						break;
-					}
-				}
-				m_buffer << ": ";
 			}
 
 			// Destructor, causes the debug info to be outputted with new line
 			virtual ~DebugLogger() {
-				std::cerr << m_buffer.str() << std::endl << std::flush;
+				const std::string text = m_buffer.str();
+				if (AsyncLogWriter::Instance().Push(m_severity, m_showtime, m_time, text.data(), text.size(), m_suppressed)) {
+					return;
+				}
+				std::string line;
+				format(line, m_severity, m_showtime, m_time, nullptr, text.data(), text.size(), m_suppressed);
+				std::cerr << line << std::flush;
+			}
+
+			/**
+			 * Log a message of LOGF_*(), every "{}" in format is replaced by 
+			 * the next argument. format must be a string literal, only its
+			 * pointer is kept until the message is written. suppressed is
+			 * the count of skipped messages from a rate limited call site.
+			 */
+			template <typename... Args>
+			static void Write(DebugLogLevel severity, uint64_t suppressed, const char* format, const Args&... args) {
+				const AsyncLogWriter::TimePoint time = LogClock::Now();
+				auto fill = [&](char* data) {
+					LogArgs encoder(data, AsyncLogWriter::KRecordText);
+					encoder.Add(args...);
+					return encoder.Size();
+				};
+				if (AsyncLogWriter::Instance().Emplace(severity, true, time, format, suppressed, fill)) {
+					return;
+				}
+				char data[AsyncLogWriter::KRecordText];
+				thread_local std::string line;
+				line.clear();
+				DebugLogger::format(line, severity, true, time, format, data, fill(data), suppressed);
+				std::cerr << line << std::flush;
 			}
 
 			/**
@@ -104,16 +762,77 @@ namespace codesmith
 				m_buffer << value;
 				return *this;
 			}
+
+			/**
+			 * Write the messages on a background thread from now on. capacity
+			 * is the number of messages the ring buffer holds, policy tells
+			 * what to do when it is full.
+			 */
+			static void StartAsync(size_t capacity = 4096, LogOverflow policy = LogOverflow::EDROP) {
+				AsyncLogWriter::Instance().Start(&DebugLogger::format, capacity, policy);
+			}
+
+			/// Write all queued messages, then go back to writing them directly
+			static void StopAsync() {
+				AsyncLogWriter::Instance().Stop();
+			}
+
+			/// Wait until all messages logged so far have been written
+			static void Flush() {
+				AsyncLogWriter::Instance().Flush();
+			}
+
 		private:
-			void make_time() {
-				std::time_t t_now = std::chrono::system_clock::to_time_t(
-					std::chrono::system_clock::now());
-				localtime_s(&m_stm, &t_now);
+			/**
+			 * Appends one complete line, "[date time.ms] LEVEL: text", to out.
+			 * The text is data, or format with the arguments encoded in data.
+			 */
+			static void format(std::string& out, DebugLogLevel severity, bool showtime,
+				const AsyncLogWriter::TimePoint& time, const char* format, const char* data, size_t length, uint64_t suppressed) {
+				if (showtime) {
+					out += '[';
+					LogClock::Append(out, time);
+					out += "] ";
+				}
+
+				switch(severity) {
+					case DebugLogLevel::EWARN:
+					{
+						out += KTextLevelWarn;
+						break;
+					}
+				case DebugLogLevel::EERROR:
+					{
+						out += KTextLevelError;
+						break;
+					}
+					default:
+					{
+						out += KTextLevelInfo;
+						break;
+					}
+				}
+				out += ": ";
+				if (format != nullptr) {
+					LogArgs::Format(out, format, data, length);
+				}
+				else {
+					out.append(data, length);
+				}
+				if (suppressed > 0) {
+					out += " (";
+					out += std::to_string(suppressed);
+					out += " similar messages suppressed)";
+				}
+				out += '\n';
 			}
 
 		private:
 			std::ostringstream m_buffer;
-			struct std::tm m_stm;
+			DebugLogLevel m_severity;
+			bool m_showtime;
+			uint64_t m_suppressed;
+			AsyncLogWriter::TimePoint m_time;
 		};
 	} // debug
 } // codesmith
@@ -124,21 +843,87 @@ using namespace codesmith::debug;
  * Helper macros/defines for using the DebugLogger
  */
 
+// Levels below DEBUGLOGGER_MIN_LEVEL expand to a loop which never runs, 
+// the compiler checks the statement but generates no code for it
+#define DEBUGLOGGER_OFF while (false)
+#define DEBUGLOGGER_LOGF(severity, ...) codesmith::debug::DebugLogger::Write(severity, 0, __VA_ARGS__)
+
+// Rate limiting, check is a LogLimiter method call which sets debuglogger_suppressed.
+// The lambda gives every call site a static LogLimiter of its own.
+#define DEBUGLOGGER_LIMIT(check) \
+	for (uint64_t debuglogger_suppressed = 0, debuglogger_pass = \
+		([]() -> codesmith::debug::LogLimiter& { static codesmith::debug::LogLimiter limiter; return limiter; }()).check; \
+		debuglogger_pass != 0; debuglogger_pass = 0)
+#define DEBUGLOGGER_LOGF_LIMIT(severity, check, ...) do { \
+	static codesmith::debug::LogLimiter debuglogger_limiter; \
+	uint64_t debuglogger_suppressed = 0; \
+	if (debuglogger_limiter.check) \
+		codesmith::debug::DebugLogger::Write(severity, debuglogger_suppressed, __VA_ARGS__); } while (0)
+
+#if DEBUGLOGGER_MIN_LEVEL <= 0
+	#define DEBUGLOGGER_ON_INFO
+#else
+	#define DEBUGLOGGER_ON_INFO DEBUGLOGGER_OFF
+#endif
+#if DEBUGLOGGER_MIN_LEVEL <= 1
+	#define DEBUGLOGGER_ON_WARN
+#else
+	#define DEBUGLOGGER_ON_WARN DEBUGLOGGER_OFF
+#endif
+#if DEBUGLOGGER_MIN_LEVEL <= 2
+	#define DEBUGLOGGER_ON_ERROR
+#else
+	#define DEBUGLOGGER_ON_ERROR DEBUGLOGGER_OFF
+#endif
+
 // Default logger, severity level is ERROR, with a time stamp
-#define LOG() DebugLogger()
+#define LOG() DEBUGLOGGER_ON_ERROR DebugLogger()
 
 // Default logger, severity level is ERROR, without a time stamp
-#define LOG_NT() DebugLogger()
+#define LOG_NT() DEBUGLOGGER_ON_ERROR DebugLogger()
 
 // These variants show system time
-#define LOG_INFO() DebugLogger(DebugLogLevel::EINFO)
-#define LOG_WARN() DebugLogger(DebugLogLevel::EWARN)
-#define LOG_ERROR() DebugLogger(DebugLogLevel::EERROR)
+#define LOG_INFO() DEBUGLOGGER_ON_INFO DebugLogger(DebugLogLevel::EINFO)
+#define LOG_WARN() DEBUGLOGGER_ON_WARN DebugLogger(DebugLogLevel::EWARN)
+#define LOG_ERROR() DEBUGLOGGER_ON_ERROR DebugLogger(DebugLogLevel::EERROR)
 
 // These variants omit the system time and only show the warning level
-#define LOG_INFO_NT() DebugLogger(DebugLogLevel::EINFO, false)
-#define LOG_WARN_NT() DebugLogger(DebugLogLevel::EWARN, false)
-#define LOG_ERROR_NT() DebugLogger(DebugLogLevel::EERROR, false)
+#define LOG_INFO_NT() DEBUGLOGGER_ON_INFO DebugLogger(DebugLogLevel::EINFO, false)
+#define LOG_WARN_NT() DEBUGLOGGER_ON_WARN DebugLogger(DebugLogLevel::EWARN, false)
+#define LOG_ERROR_NT() DEBUGLOGGER_ON_ERROR DebugLogger(DebugLogLevel::EERROR, false)
+
+// Deferred formatting with a time stamp, LOGF_INFO("x = {}", x)
+#define LOGF_INFO(...) DEBUGLOGGER_ON_INFO DEBUGLOGGER_LOGF(DebugLogLevel::EINFO, __VA_ARGS__)
+#define LOGF_WARN(...) DEBUGLOGGER_ON_WARN DEBUGLOGGER_LOGF(DebugLogLevel::EWARN, __VA_ARGS__)
+#define LOGF_ERROR(...) DEBUGLOGGER_ON_ERROR DEBUGLOGGER_LOGF(DebugLogLevel::EERROR, __VA_ARGS__)
+
+// Rate limited variants with a time stamp, see LogLimiter
+#define LOG_INFO_EVERY_N(n) DEBUGLOGGER_ON_INFO DEBUGLOGGER_LIMIT(EveryN(n, debuglogger_suppressed)) \
+	DebugLogger(DebugLogLevel::EINFO, true, debuglogger_suppressed)
+#define LOG_WARN_EVERY_N(n) DEBUGLOGGER_ON_WARN DEBUGLOGGER_LIMIT(EveryN(n, debuglogger_suppressed)) \
+	DebugLogger(DebugLogLevel::EWARN, true, debuglogger_suppressed)
+#define LOG_ERROR_EVERY_N(n) DEBUGLOGGER_ON_ERROR DEBUGLOGGER_LIMIT(EveryN(n, debuglogger_suppressed)) \
+	DebugLogger(DebugLogLevel::EERROR, true, debuglogger_suppressed)
+
+#define LOG_INFO_EVERY_MS(ms) DEBUGLOGGER_ON_INFO DEBUGLOGGER_LIMIT(EveryMs(ms, debuglogger_suppressed)) \
+	DebugLogger(DebugLogLevel::EINFO, true, debuglogger_suppressed)
+#define LOG_WARN_EVERY_MS(ms) DEBUGLOGGER_ON_WARN DEBUGLOGGER_LIMIT(EveryMs(ms, debuglogger_suppressed)) \
+	DebugLogger(DebugLogLevel::EWARN, true, debuglogger_suppressed)
+#define LOG_ERROR_EVERY_MS(ms) DEBUGLOGGER_ON_ERROR DEBUGLOGGER_LIMIT(EveryMs(ms, debuglogger_suppressed)) \
+	DebugLogger(DebugLogLevel::EERROR, true, debuglogger_suppressed)
+
+#define LOG_ONCE() DEBUGLOGGER_ON_ERROR DEBUGLOGGER_LIMIT(Once(debuglogger_suppressed)) DebugLogger()
+#define LOG_INFO_ONCE() DEBUGLOGGER_ON_INFO DEBUGLOGGER_LIMIT(Once(debuglogger_suppressed)) DebugLogger(DebugLogLevel::EINFO)
+#define LOG_WARN_ONCE() DEBUGLOGGER_ON_WARN DEBUGLOGGER_LIMIT(Once(debuglogger_suppressed)) DebugLogger(DebugLogLevel::EWARN)
+#define LOG_ERROR_ONCE() DEBUGLOGGER_ON_ERROR DEBUGLOGGER_LIMIT(Once(debuglogger_suppressed)) DebugLogger(DebugLogLevel::EERROR)
+
+#define LOGF_INFO_EVERY_N(n, ...) DEBUGLOGGER_ON_INFO DEBUGLOGGER_LOGF_LIMIT(DebugLogLevel::EINFO, EveryN(n, debuglogger_suppressed), __VA_ARGS__)
+#define LOGF_WARN_EVERY_N(n, ...) DEBUGLOGGER_ON_WARN DEBUGLOGGER_LOGF_LIMIT(DebugLogLevel::EWARN, EveryN(n, debuglogger_suppressed), __VA_ARGS__)
+#define LOGF_ERROR_EVERY_N(n, ...) DEBUGLOGGER_ON_ERROR DEBUGLOGGER_LOGF_LIMIT(DebugLogLevel::EERROR, EveryN(n, debuglogger_suppressed), __VA_ARGS__)
+
+#define LOGF_INFO_EVERY_MS(ms, ...) DEBUGLOGGER_ON_INFO DEBUGLOGGER_LOGF_LIMIT(DebugLogLevel::EINFO, EveryMs(ms, debuglogger_suppressed), __VA_ARGS__)
+#define LOGF_WARN_EVERY_MS(ms, ...) DEBUGLOGGER_ON_WARN DEBUGLOGGER_LOGF_LIMIT(DebugLogLevel::EWARN, EveryMs(ms, debuglogger_suppressed), __VA_ARGS__)
+#define LOGF_ERROR_EVERY_MS(ms, ...) DEBUGLOGGER_ON_ERROR DEBUGLOGGER_LOGF_LIMIT(DebugLogLevel::EERROR, EveryMs(ms, debuglogger_suppressed), __VA_ARGS__)
 
 
 #endif // __DEBUGLOGGER_DEFINED_H__
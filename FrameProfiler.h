@@ -0,0 +1,428 @@
+/*
+	FrameProfiler.h
+	+-------------------------------------------------------------+
+	|         OneLoneCoder Pixel Game Engine Extension            |
+	|                FrameProfiler - v0.1.0                       |
+	+-------------------------------------------------------------+
+
+	What is this?
+	~~~~~~~~~~~~~
+	Measures how long every OnUserUpdate() takes, and the time between
+	frames, and keeps them in histograms for the p50/p95/p99/max report.
+	GetFPS() is an average over one second and hides single slow frames,
+	this shows them. Frames whose update takes longer than the budget are
+	recorded as hitches, with the number of RenderBatch entries at that
+	moment, and written to the DebugLogger.
+
+	Optionally draws a graph of the last frames on top of the screen,
+	as one decal.
+
+	The profiler hooks into the engine itself, it only has to be created
+	after the PixelGameEngine, e.g. as a member of the application.
+
+	For example on how to use, see RenderBatchDemo.cpp.
+
+
+	License (OLC-3)
+	~~~~~~~~~~~~~~~
+
+	Copyright 2018 - 2021 OneLoneCoder.com
+
+	Redistribution and use in source and binary forms, with or without modification,
+	are permitted provided that the following conditions are met:
+
+	1. Redistributions or derivations of source code must retain the above copyright
+	notice, this list of conditions and the following disclaimer.
+
+	2. Redistributions or derivative works in binary form must reproduce the above
+	copyright notice. This list of conditions and the following	disclaimer must be
+	reproduced in the documentation and/or other materials provided with the distribution.
+
+	3. Neither the name of the copyright holder nor the names of its contributors may
+	be used to endorse or promote products derived from this software without specific
+	prior written permission.
+
+	THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS	"AS IS" AND ANY
+	EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+	OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+	SHALL THE COPYRIGHT	HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+	INCIDENTAL,	SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+	TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+	BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+	CONTRACT, STRICT LIABILITY, OR TORT	(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+	ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+	SUCH DAMAGE.
+
+	Links
+	~~~~~
+	Homepage:	https://github.com/codesmith-fi
+	Mail:		codesmith.fi@gmail.com
+
+	Author
+	~~~~~~
+	Erno Pakarinen (aka xanaki#9472 in discord, aka codesmith-fi)
+
+*/
+
+#ifndef __FRAMEPROFILER_H_DEFINED__
+#define __FRAMEPROFILER_H_DEFINED__
+
+#include <vector>
+#include <chrono>
+#include <cstdint>
+#include <algorithm>
+#include <cmath>
+
+#include "RenderBatch.h"
+#include "DebugLogger.h"
+
+namespace olc {
+
+/// Histogram of 32 bit values in log-linear buckets, like HdrHistogram.
+/// Values below 64 have buckets of their own, larger values share a 
+/// bucket with at most 1/32 (3%) of their neighbours. The buckets are
+/// allocated once, so recording never allocates.
+class FrameHistogram
+{
+public:
+	FrameHistogram() : m_counts(KBuckets, 0) { };
+
+	void Record(uint32_t _value);
+
+	/// Smallest value which _percent % of the recorded values are at or 
+	/// below, as the upper bound of its bucket but never above Max()
+	uint32_t Percentile(double _percent) const;
+
+	inline uint64_t Count() const { return m_count; }
+	inline uint32_t Max() const { return m_max; }
+	inline double Mean() const { return m_count > 0 ? (double)m_sum / (double)m_count : 0.0; }
+
+	void Reset();
+
+private:
+	static constexpr uint32_t KSubBits = 5;
+	static constexpr uint32_t KSub = 1u << KSubBits;
+	// Enough for values up to 2^31 - 1, larger ones are clamped
+	static constexpr uint32_t KBuckets = (32 - KSubBits) * KSub;
+	static constexpr uint32_t KMaxValue = 0x7fffffffu;
+
+	/** Bucket of _value, the first 2 * KSub buckets are exact */
+	static uint32_t bucket(uint32_t _value);
+	/** Largest value which goes into _bucket */
+	static uint32_t upperBound(uint32_t _bucket);
+
+private:
+	std::vector<uint32_t> m_counts;
+	uint64_t m_count = 0;
+	uint64_t m_sum = 0;
+	uint32_t m_max = 0;
+};
+
+class FrameProfiler : public olc::PGEX
+{
+public: // Enums
+	enum class Source {
+		// From the start to the end of OnUserUpdate()
+		UPDATE,
+		// fElapsedTime, the time from the previous frame, includes the 
+		// rendering and waiting for vsync
+		FRAME
+	};
+
+public: // Types
+	/// A frame whose update took longer than the budget
+	struct Hitch {
+		// Number of the frame, counted from the first update
+		uint64_t frame = 0;
+		float updateMs = 0.0f;
+		float frameMs = 0.0f;
+		// RenderBatch::GetStats().entries after the update
+		size_t entries = 0;
+	};
+
+	/// Times in milliseconds since the last Reset()
+	struct Report {
+		uint64_t frames = 0;
+		float mean = 0.0f;
+		float p50 = 0.0f;
+		float p95 = 0.0f;
+		float p99 = 0.0f;
+		float max = 0.0f;
+		// Frames over the budget
+		uint64_t overBudget = 0;
+	};
+
+public:
+	/// Hooks into the engine, which must exist already. _budgetMs is
+	/// the longest update which is not a hitch.
+	explicit FrameProfiler(float _budgetMs = 1000.0f / 60.0f);
+	virtual ~FrameProfiler() = default;
+
+	FrameProfiler(const FrameProfiler&) = delete;
+	FrameProfiler& operator=(const FrameProfiler&) = delete;
+
+	inline void SetBudget(float _budgetMs) { m_budgetMs = _budgetMs; }
+	inline float GetBudget() const { return m_budgetMs; }
+
+	/// Hitches record the entry count of the last End() of _batch,
+	/// nullptr records 0
+	inline void SetRenderBatch(const olc::RenderBatch* _batch) { m_batch = _batch; }
+
+	/// Write a warning to the DebugLogger for hitches, at most one per
+	/// second. On by default.
+	inline void SetLogHitches(bool _enable) { m_logHitches = _enable; }
+
+	/// Draw a graph of the last KGraphWidth frames at _pos, as one decal
+	/// into the current draw target layer. Green bars are updates within
+	/// the budget, red ones over it, grey behind them is the whole frame.
+	/// The line in the middle is the budget.
+	void SetOverlay(bool _enable, const olc::vf2d& _pos = olc::vf2d(10.0f, 40.0f));
+	inline bool Overlay() const { return m_overlay; }
+
+	Report GetReport(Source _source = Source::UPDATE) const;
+
+	/// The last KMaxHitches hitches since Reset(), the oldest first
+	std::vector<Hitch> GetHitches() const;
+
+	/// Forget the recorded frames and hitches
+	void Reset();
+
+	static constexpr int32_t KGraphWidth = 240;
+	static constexpr int32_t KGraphHeight = 60;
+	static constexpr size_t KMaxHitches = 64;
+
+protected:
+	void OnBeforeUserUpdate(float& fElapsedTime) override;
+	void OnAfterUserUpdate(float fElapsedTime) override;
+
+private:
+	struct Sample {
+		float updateMs;
+		float frameMs;
+	};
+
+	/** Draws the history into m_graph and the decal of it */
+	void drawOverlay();
+
+private:
+	float m_budgetMs;
+	const olc::RenderBatch* m_batch = nullptr;
+	bool m_logHitches = true;
+	bool m_overlay = false;
+	olc::vf2d m_overlayPos;
+
+	std::chrono::steady_clock::time_point m_start;
+	float m_frameMs = 0.0f;
+	uint64_t m_frames = 0;
+
+	// Microseconds
+	FrameHistogram m_updateTimes;
+	FrameHistogram m_frameTimes;
+	uint64_t m_updateOver = 0;
+	uint64_t m_frameOver = 0;
+
+	// Ring buffers, m_nextHitch and m_nextSample is the oldest once full
+	std::vector<Hitch> m_hitches;
+	size_t m_nextHitch = 0;
+	std::vector<Sample> m_samples;
+	size_t m_nextSample = 0;
+	olc::Renderable m_graph;
+};
+
+} // namespace olc
+
+#ifdef OLC_PGEX_FRAMEPROFILER
+#undef OLC_PGEX_FRAMEPROFILER
+
+namespace olc {
+	void FrameHistogram::Record(uint32_t _value)
+	{
+		if (_value > KMaxValue) {
+			_value = KMaxValue;
+		}
+		++m_counts[bucket(_value)];
+		++m_count;
+		m_sum += _value;
+		m_max = std::max(m_max, _value);
+	}
+
+	uint32_t FrameHistogram::Percentile(double _percent) const
+	{
+		if (m_count == 0) {
+			return 0;
+		}
+		// Rank of the value, 1 is the smallest
+		uint64_t rank = (uint64_t)std::ceil(std::min(std::max(_percent, 0.0), 100.0) / 100.0 * (double)m_count);
+		rank = std::max(rank, (uint64_t)1);
+		uint64_t seen = 0;
+		for (uint32_t i = 0; i < KBuckets; ++i) {
+			seen += m_counts[i];
+			if (seen >= rank) {
+				return std::min(upperBound(i), m_max);
+			}
+		}
+		return m_max;
+	}
+
+	void FrameHistogram::Reset()
+	{
+		std::fill(m_counts.begin(), m_counts.end(), 0);
+		m_count = 0;
+		m_sum = 0;
+		m_max = 0;
+	}
+
+	uint32_t FrameHistogram::bucket(uint32_t _value)
+	{
+		if (_value < 2 * KSub) {
+			return _value;
+		}
+		// Keep the KSubBits + 1 highest bits, the top one is implicit
+		uint32_t shift = 0;
+		while ((_value >> shift) >= 2 * KSub) {
+			++shift;
+		}
+		return (shift + 1) * KSub + ((_value >> shift) - KSub);
+	}
+
+	uint32_t FrameHistogram::upperBound(uint32_t _bucket)
+	{
+		if (_bucket < 2 * KSub) {
+			return _bucket;
+		}
+		const uint32_t shift = _bucket / KSub - 1;
+		const uint32_t lower = (KSub + _bucket % KSub) << shift;
+		return lower + ((1u << shift) - 1);
+	}
+
+	FrameProfiler::FrameProfiler(float _budgetMs) :
+		olc::PGEX(true), m_budgetMs(_budgetMs), m_samples(KGraphWidth, { 0.0f, 0.0f })
+	{
+		m_hitches.reserve(KMaxHitches);
+	}
+
+	void FrameProfiler::SetOverlay(bool _enable, const olc::vf2d& _pos)
+	{
+		m_overlay = _enable;
+		m_overlayPos = _pos;
+	}
+
+	FrameProfiler::Report FrameProfiler::GetReport(Source _source) const
+	{
+		const FrameHistogram& histogram = _source == Source::UPDATE ? m_updateTimes : m_frameTimes;
+		Report report;
+		report.frames = histogram.Count();
+		report.mean = (float)(histogram.Mean() / 1000.0);
+		report.p50 = histogram.Percentile(50.0) / 1000.0f;
+		report.p95 = histogram.Percentile(95.0) / 1000.0f;
+		report.p99 = histogram.Percentile(99.0) / 1000.0f;
+		report.max = histogram.Max() / 1000.0f;
+		report.overBudget = _source == Source::UPDATE ? m_updateOver : m_frameOver;
+		return report;
+	}
+
+	std::vector<FrameProfiler::Hitch> FrameProfiler::GetHitches() const
+	{
+		std::vector<Hitch> hitches(m_hitches.begin() + m_nextHitch, m_hitches.end());
+		hitches.insert(hitches.end(), m_hitches.begin(), m_hitches.begin() + m_nextHitch);
+		return hitches;
+	}
+
+	void FrameProfiler::Reset()
+	{
+		m_updateTimes.Reset();
+		m_frameTimes.Reset();
+		m_updateOver = 0;
+		m_frameOver = 0;
+		m_hitches.clear();
+		m_nextHitch = 0;
+	}
+
+	void FrameProfiler::OnBeforeUserUpdate(float& fElapsedTime)
+	{
+		// The first fElapsedTime includes the start up
+		m_frameMs = m_frames > 0 ? fElapsedTime * 1000.0f : 0.0f;
+		if (m_frames > 0) {
+			m_frameTimes.Record((uint32_t)(fElapsedTime * 1000000.0f));
+			if (m_frameMs > m_budgetMs) {
+				++m_frameOver;
+			}
+		}
+		m_start = std::chrono::steady_clock::now();
+	}
+
+	void FrameProfiler::OnAfterUserUpdate(float /*fElapsedTime*/)
+	{
+		const auto end = std::chrono::steady_clock::now();
+		const uint32_t us = (uint32_t)std::chrono::duration_cast<std::chrono::microseconds>(end - m_start).count();
+		const float updateMs = us / 1000.0f;
+		m_updateTimes.Record(us);
+
+		if (updateMs > m_budgetMs) {
+			++m_updateOver;
+			Hitch hitch;
+			hitch.frame = m_frames;
+			hitch.updateMs = updateMs;
+			hitch.frameMs = m_frameMs;
+			hitch.entries = m_batch ? m_batch->GetStats().entries : 0;
+			if (m_hitches.size() < KMaxHitches) {
+				m_hitches.push_back(hitch);
+			}
+			else {
+				m_hitches[m_nextHitch] = hitch;
+				m_nextHitch = (m_nextHitch + 1) % KMaxHitches;
+			}
+			if (m_logHitches) {
+				LOGF_WARN_EVERY_MS(1000, "Hitch in frame {}: update {} ms, budget {} ms, {} entries",
+					hitch.frame, hitch.updateMs, m_budgetMs, hitch.entries);
+			}
+		}
+
+		m_samples[m_nextSample] = { updateMs, m_frameMs };
+		m_nextSample = (m_nextSample + 1) % m_samples.size();
+		++m_frames;
+
+		if (m_overlay) {
+			drawOverlay();
+		}
+	}
+
+	void FrameProfiler::drawOverlay()
+	{
+		if (m_graph.Decal() == nullptr) {
+			m_graph.Create(KGraphWidth, KGraphHeight);
+		}
+		olc::Sprite* sprite = m_graph.Sprite();
+		const olc::Pixel background(0, 0, 0, 160);
+		const olc::Pixel frame(96, 96, 96);
+		const olc::Pixel within(0, 200, 0);
+		const olc::Pixel over(230, 0, 0);
+		const olc::Pixel budget(255, 255, 0);
+		// The full height is twice the budget
+		const int32_t height = KGraphHeight;
+		const float pixelsPerMs = height / (2.0f * m_budgetMs);
+
+		// Tops of the bars of each column, oldest sample on the left
+		int32_t updateTop[KGraphWidth];
+		int32_t frameTop[KGraphWidth];
+		bool overBudget[KGraphWidth];
+		for (int32_t x = 0; x < KGraphWidth; ++x) {
+			const Sample& sample = m_samples[(m_nextSample + x) % m_samples.size()];
+			updateTop[x] = height - std::min(height, (int32_t)(sample.updateMs * pixelsPerMs + 0.5f));
+			frameTop[x] = height - std::min(height, (int32_t)(sample.frameMs * pixelsPerMs + 0.5f));
+			overBudget[x] = sample.updateMs > m_budgetMs;
+		}
+		olc::Pixel* pixel = sprite->pColData.data();
+		for (int32_t y = 0; y < height; ++y) {
+			const olc::Pixel empty = y == height / 2 ? budget : background;
+			for (int32_t x = 0; x < KGraphWidth; ++x) {
+				*pixel++ = y >= updateTop[x] ? (overBudget[x] ? over : within) : (y >= frameTop[x] ? frame : empty);
+			}
+		}
+		m_graph.Decal()->Update();
+		pge->DrawDecal(m_overlayPos, m_graph.Decal());
+	}
+} // namespace olc
+
+#endif // OLC_PGEX_FRAMEPROFILER
+#endif // __FRAMEPROFILER_H_DEFINED__
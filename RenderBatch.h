@@ -61,9 +61,22 @@
 #define __RENDERBATCH_H_DEFINED__
 
 #include <list>
+#include <vector>
+#include <unordered_map>
+#include <algorithm>
 #include <memory>
+#include <cmath>
 #include <assert.h>
 
+#include "ThreadPool.h"
+#include "TextureCache.h"
+
+// SSE2 blending for the software target, see RenderBatch::SetTarget()
+#if !defined(OLC_RENDERBATCH_NO_SIMD) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#define OLC_RENDERBATCH_SSE2
+#include <emmintrin.h>
+#endif
+
 namespace olc {
 
 template<class T>
@@ -181,17 +194,58 @@ public:
 		olc::Renderable* d, 
 		const olc::vf2d& p,
 		const olc::vf2d& targetsize,
-		float order = 1.0f) : renderable(d), position(p), size(targetsize), z(order) {
+		float order = 1.0f,
+		const olc::Pixel& color = olc::WHITE,
+		olc::DecalMode blend = olc::DecalMode::NORMAL,
+		float rotation = 0.0f,
+		const olc::vf2d& pivot = olc::vf2d(0.0f, 0.0f),
+		uint8_t flipflags = olc::Sprite::NONE) : 
+		renderable(d), position(p), size(targetsize), z(order), tint(color), mode(blend),
+		angle(rotation), origin(pivot), flip(flipflags) {
 	}
 	virtual ~RenderBatchEntry() {};
 
+	/// True if this entry has to be submitted as an explicit quad
+	inline bool transformed() const { 
+		return angle != 0.0f || flip != olc::Sprite::NONE || origin.x != 0.0f || origin.y != 0.0f;
+	}
+
 public: // Data
 	olc::Renderable* renderable;
 	olc::vf2d position;
 	olc::vf2d size;
 	float z;
+	olc::Pixel tint;
+	olc::DecalMode mode;
+	// Rotation in radians around origin, origin is relative to the top left
+	// corner of the target rectangle. For transformed entries position is 
+	// the screen position of the origin.
+	float angle;
+	olc::vf2d origin;
+	uint8_t flip;
 };
 
+/**
+ * Quantized batch entry used by RenderBatch in compact mode, see 
+ * RenderBatch::SetCompact(). No vtable, the Renderable is an index into
+ * the texture table of the batch, positions and sizes are 13.3 fixed point
+ * (positions relative to the batch origin) and Z is a 16-bit bucket.
+ */
+struct RenderBatchCompactEntry
+{
+	uint16_t texture;
+	uint16_t z;
+	int16_t x, y;
+	int16_t w, h;
+	int16_t ox, oy;
+	// Full turn is 65536
+	int16_t angle;
+	uint8_t mode;
+	uint8_t flip;
+	uint32_t tint;
+};
+static_assert(sizeof(RenderBatchCompactEntry) <= 32, "RenderBatchCompactEntry must stay at or under 32 bytes");
+
 class RenderBatch : public olc::PGEX
 {
 public: // Enums
@@ -204,6 +258,34 @@ public: // Enums
 		UNORDERED
 	};
 
+	enum class RotationMode {
+		// std::sin() and std::cos() once per rotated entry
+		EXACT,
+		// Lookup table, angle is quantized to 1/4096 of a full turn
+		FAST
+	};
+
+	enum class Filter {
+		// Nearest texel, as a Renderable created without filtering
+		NEAREST,
+		// Bilinear between the 4 nearest texels, edges clamped
+		BILINEAR
+	};
+
+public: // Types
+	/// Per frame statistics of the occlusion culling pass, see 
+	/// SetOcclusionCulling(). Areas are in screen pixels, clipped to the screen.
+	struct Stats {
+		// Entries given to Draw() since Begin()
+		size_t entries = 0;
+		// Entries dropped as fully hidden or completely off screen
+		size_t culled = 0;
+		// Covered area of all entries divided by the screen area
+		float overdraw = 0.0f;
+		// As above, but only for the entries which were drawn
+		float overdrawCulled = 0.0f;
+	};
+
 public:
 	RenderBatch(const DrawOrder& order = DrawOrder::UNORDERED) :
 		m_order(order), m_active(false) { };
@@ -212,6 +294,72 @@ public:
 	/// Set the desired Z ordering. 
 	inline void SetOrder(const DrawOrder& order) { m_order = order;}
 
+	/// Set how sin/cos are evaluated for rotated entries in End()
+	inline void SetRotationMode(const RotationMode& mode) { m_rotationMode = mode; }
+
+	/// Enable dropping of entries which are completely hidden behind opaque
+	/// entries in front of them, or completely outside of the screen.
+	/// Only axis aligned entries of opaque Renderables drawn with 
+	/// DecalMode::NORMAL and an opaque tint can hide other entries.
+	inline void SetOcclusionCulling(bool _enable) { m_occlusionCulling = _enable; }
+
+	/// Scan the alpha channel of a Renderable once, preferably right after
+	/// loading it. Renderables which were not scanned are scanned the first
+	/// time they are seen by the culling pass, and again after Load() or 
+	/// Create() has given them another image.
+	void ScanOpacity(olc::Renderable* _renderable);
+
+	/// Statistics of the last End()
+	inline const Stats& GetStats() const { return m_stats; }
+
+	/// Store entries in the quantized RenderBatchCompactEntry format, which
+	/// is less than half the size of a RenderBatchEntry in a list node. 
+	/// Entries are sorted once in End() instead of on every Draw().
+	/// Positions are relative to the compact origin and must stay within
+	/// +-4096 pixels of it, sizes below 4096 pixels, with 1/8 pixel precision.
+	/// Z is quantized to 65536 buckets over the compact Z range. 
+	/// A batch with an entry outside these limits is drawn in list mode 
+	/// from that entry on, like a batch with too many Renderables.
+	/// Entries with the same Z bucket are drawn as equal Z entries in list
+	/// mode, newest first within a blend mode, but the mode groups are in
+	/// DecalMode order instead of the reverse order of their first use.
+	/// A batch with more than 65536 different Renderables is drawn in
+	/// list mode from the first one which does not fit.
+	/// Can only be changed outside of Begin() and End().
+	void SetCompact(bool _enable);
+	inline bool Compact() const { return m_compact; }
+	inline void SetCompactOrigin(const olc::vf2d& _origin) { m_compactOrigin = _origin; }
+	inline void SetCompactZRange(float _min, float _max) { m_zMin = _min; m_zMax = _max; }
+
+	/// Rasterize the entries into _target in End() instead of drawing them
+	/// as decals, for example into a layer's draw target or into an off 
+	/// screen sprite when there is no GPU. Blending follows the GPU blend 
+	/// function of each DecalMode. nullptr switches back to decals.
+	inline void SetTarget(olc::Sprite* _target) { m_target = _target; }
+	inline olc::Sprite* GetTarget() const { return m_target; }
+
+	/// Texture filtering used by the software target
+	inline void SetFilter(const Filter& _filter) { m_filter = _filter; }
+
+	/// Split the software target into square tiles of _tileSize pixels 
+	/// and rasterize them on the threads of _pool. Entries are binned per 
+	/// tile and every tile draws its entries in the batch order, so the
+	/// result is identical for any number of threads, and to the result
+	/// without a pool. nullptr rasterizes the target on the calling thread.
+	void SetThreadPool(olc::ThreadPool* _pool, int _tileSize = 64);
+
+	/// Renderable drawn in place of ones which are not loaded yet, i.e.
+	/// have no Decal, like those of an AsyncLoader. With nullptr they
+	/// are skipped.
+	inline void SetPlaceholder(olc::Renderable* _placeholder) { m_placeholder = _placeholder; }
+
+	/// Report every Draw() to _cache, which uploads evicted textures of its
+	/// Renderables again and keeps track of the least recently used ones.
+	inline void SetTextureCache(olc::TextureCache* _cache) { m_textureCache = _cache; }
+
+	/// True if every pixel of the sprite has alpha 255
+	static bool IsOpaque(const olc::Sprite* _sprite);
+
 	/// Begin drawing with this RenderBatch
 	/// Makes this RenderBatch active allowing calls to Draw() and End() etc.
 	void Begin();
@@ -226,6 +374,25 @@ public:
 		const olc::vf2d& _size,	float _z, olc::Camera2D* _camera = nullptr);
 	void Draw( olc::Renderable* _renderable, const olc::vf2d& _pos, float _scale,
 		float _z, olc::Camera2D* _camera = nullptr);
+
+	/// As above, but with a tint colour and a blend mode for this entry.
+	/// End() groups entries by blend mode where the Z order allows it and 
+	/// only switches the PGE decal mode when it actually changes.
+	void Draw(olc::Renderable* _renderable, const olc::vf2d& _pos,
+		const olc::vf2d& _size, float _z, const olc::Pixel& _tint,
+		olc::DecalMode _mode = olc::DecalMode::NORMAL, olc::Camera2D* _camera = nullptr);
+	void Draw(olc::Renderable* _renderable, const olc::vf2d& _pos, float _scale,
+		float _z, const olc::Pixel& _tint,
+		olc::DecalMode _mode = olc::DecalMode::NORMAL, olc::Camera2D* _camera = nullptr);
+
+	/// Draw a Renderable rotated by _angle (radians) around _origin, which is
+	/// given in source sprite pixels like with PGE's DrawRotatedDecal(). 
+	/// _pos is where the origin ends up on the screen. _flip takes 
+	/// olc::Sprite::Flip values. The quad corners are generated in End().
+	void Draw(olc::Renderable* _renderable, const olc::vf2d& _pos, 
+		const olc::vf2d& _scale, float _angle, const olc::vf2d& _origin, float _z,
+		uint8_t _flip = olc::Sprite::NONE, const olc::Pixel& _tint = olc::WHITE,
+		olc::DecalMode _mode = olc::DecalMode::NORMAL, olc::Camera2D* _camera = nullptr);
 private:
 	/**
 	 * Insert a RenderBatchEntry in desired Z order, either z increasing, 
@@ -234,12 +401,201 @@ private:
 	 * is the insertion order
 	 */
 	void insertBatchEntry(RenderBatchEntry& _entry, Camera2D* _camera);
+	/** Insert _entry into m_drawables at its place in the draw order */
+	void insertListEntry(const RenderBatchEntry& _entry);
+	/**
+	 * Move the compact entries of this batch into m_drawables and draw
+	 * the rest of the batch in list mode, when the texture table is full
+	 * or an entry does not fit the compact format
+	 */
+	void spillCompact();
+	/**
+	 * Find the insertion point inside the run of entries having the same Z 
+	 * as _entry, starting at _first. Prefers a neighbour with the same blend
+	 * mode so that End() needs fewer decal mode changes.
+	 */
+	std::list<RenderBatchEntry>::iterator sameModeInRun(
+		std::list<RenderBatchEntry>::iterator _first, const RenderBatchEntry& _entry);
 	olc::vf2d translatePosition(const olc::vf2d& _pos, const Camera2D& camera);
+	/**
+	 * Generate the screen space corners of all transformed entries into
+	 * m_quadCorners, four per entry in draw order (TL, BL, BR, TR).
+	 * Inputs are gathered into flat arrays first so the corner math runs 
+	 * as one tight loop over all rotated entries.
+	 */
+	template<class Source> void buildQuads(const Source& _source);
+	static const float* sinTable();
+	/**
+	 * Occlusion culling pass, walks the entries front to back and marks
+	 * hidden ones into m_culled. Coverage is tracked in a grid of 
+	 * KCoverageCell sized cells, a cell is covered only when an opaque entry
+	 * covers all of it. Also fills in m_stats.
+	 */
+	template<class Source> void cullOccluded(const Source& _source);
+	/**
+	 * Culling and submission of all entries given by _source in draw order.
+	 * A Source has size() and at(index) which returns a RenderBatchEntry.
+	 */
+	template<class Source> void endBatch(const Source& _source);
+
+	// Pixel rectangle, x1 and y1 are exclusive
+	struct Clip {
+		int x0, y0, x1, y1;
+	};
+
+	/** Size of the software target, or of the PGE screen */
+	olc::vi2d viewSize() const;
+	/** Rasterize all entries given by _source into m_target */
+	template<class Source> void rasterize(const Source& _source);
+	/** Mark the bounds of _corners dirty on a tracked PGE layer */
+	void markDirty(uint8_t _layer, const olc::vf2d* _corners);
+	/**
+	 * Rasterize one entry inside _clip of _target. _corners are the screen
+	 * corners TL, BL, BR, TR of the entry. Each row is clipped to the span
+	 * of pixel centres inside the quad, sampled into _span and then blended
+	 * into the target in one go.
+	 */
+	static void rasterizeEntry(const RenderBatchEntry& _entry, const olc::vf2d* _corners,
+		olc::Sprite* _target, const Clip& _clip, Filter _filter, std::vector<olc::Pixel>& _span);
+	/**
+	 * Bin m_rasterEntries into tiles of the target and rasterize the tiles
+	 * on m_pool
+	 */
+	void rasterizeTiles();
+	/** DecalMode::WIREFRAME, the outline of the quad in the tint colour */
+	static void rasterizeOutline(const RenderBatchEntry& _entry, const olc::vf2d* _corners,
+		olc::Sprite* _target, const Clip& _clip);
+	/**
+	 * Blend _count pixels of _src, modulated by _tint, into _dst with the 
+	 * GPU blend function of _mode. All channels are in 0-255 fixed point
+	 * and the SSE2 path gives exactly the same result as the scalar one.
+	 */
+	static void blendSpan(olc::Pixel* _dst, const olc::Pixel* _src, int _count,
+		olc::Pixel _tint, olc::DecalMode _mode);
+
+	// Entry sources for endBatch()
+	struct ListSource {
+		const std::vector<const RenderBatchEntry*>& entries;
+		inline size_t size() const { return entries.size(); }
+		inline const RenderBatchEntry& at(size_t _i) const { return *entries[_i]; }
+	};
+	struct DecodedSource {
+		const std::vector<RenderBatchEntry>& entries;
+		inline size_t size() const { return entries.size(); }
+		inline const RenderBatchEntry& at(size_t _i) const { return entries[_i]; }
+	};
+
+	RenderBatchCompactEntry encode(const RenderBatchEntry& _entry);
+	RenderBatchEntry decode(const RenderBatchCompactEntry& _entry) const;
+	uint16_t textureIndex(olc::Renderable* _renderable);
+	/** Are the position, size, origin and Z of _entry within the compact limits */
+	bool fitsCompact(const RenderBatchEntry& _entry) const;
+	/** Can textureIndex() give _renderable an index */
+	inline bool hasTextureIndex(olc::Renderable* _renderable) const {
+		return _renderable == m_lastTexture || m_textures.size() < KMaxTextures || 
+			m_textureIndex.count(_renderable) > 0;
+	}
+
+	/** The Renderable to draw for _renderable, see SetPlaceholder() */
+	inline olc::Renderable* drawable(olc::Renderable* _renderable) const {
+		if (m_textureCache != nullptr && _renderable != nullptr) {
+			m_textureCache->Touch(_renderable);
+		}
+		return _renderable == nullptr || _renderable->Decal() != nullptr ? _renderable : m_placeholder;
+	}
+	/**
+	 * The mip level of _renderable to draw at _size on the screen, the 
+	 * smallest one which is still minified, see Renderable::SetMipmaps().
+	 */
+	static inline olc::Renderable* lod(olc::Renderable* _renderable, const olc::vf2d& _size) {
+		const int32_t levels = _renderable->MipLevels();
+		if (levels <= 1) {
+			return _renderable;
+		}
+		const olc::Sprite* sprite = _renderable->Sprite();
+		// Texels per screen pixel along the more minified axis
+		float ratio = std::max(sprite->width / std::fabs(_size.x), sprite->height / std::fabs(_size.y));
+		int32_t level = 0;
+		while (ratio >= 2.0f && level + 1 < levels) {
+			ratio *= 0.5f;
+			++level;
+		}
+		return _renderable->Mip(level);
+	}
+	/**
+	 * Sort the compact entries into m_compactOrder by Z bucket and blend 
+	 * mode. Entries with the same bucket and mode are drawn newest first,
+	 * like equal Z entries of the same mode in list mode.
+	 */
+	void sortCompact();
+	/** Decode the compact entries in m_compactOrder into m_decoded */
+	void decodeCompact();
 
 private: // Data
 	std::list<RenderBatchEntry> m_drawables;
 	DrawOrder m_order = DrawOrder::UNORDERED;
+	RotationMode m_rotationMode = RotationMode::EXACT;
 	bool m_active = false;
+
+	// Scratch buffers for buildQuads(), kept to avoid allocations per frame
+	std::vector<float> m_quadIn;
+	std::vector<float> m_quadCosines;
+	std::vector<olc::vf2d> m_quadCorners;
+
+	// Occlusion culling
+	static constexpr int KCoverageCell = 16;
+	bool m_occlusionCulling = false;
+	// Opacity of each Renderable and the Renderable::ImageId() it was scanned 
+	// from, rescanned when the Renderable is given another image
+	struct Opacity {
+		uint64_t image;
+		bool opaque;
+	};
+	std::unordered_map<const olc::Renderable*, Opacity> m_opaque;
+	std::vector<uint8_t> m_coverage;
+	std::vector<uint8_t> m_culled;
+	Stats m_stats;
+
+	// Compact mode
+	static constexpr int KFixedShift = 3;
+	static constexpr size_t KMaxTextures = 0x10000;
+	bool m_compact = false;
+	// Compact mode ran out of texture indices, the batch is in m_drawables
+	bool m_spilled = false;
+	olc::vf2d m_compactOrigin = olc::vf2d(0.0f, 0.0f);
+	float m_zMin = 0.0f;
+	float m_zMax = 1.0f;
+	std::vector<RenderBatchCompactEntry> m_compactEntries;
+	std::vector<uint32_t> m_compactOrder;
+	std::vector<uint64_t> m_sortKeys;
+	// Compact entries of this frame in draw order, decoded once in End()
+	// for all the passes over them
+	std::vector<RenderBatchEntry> m_decoded;
+	std::vector<olc::Renderable*> m_textures;
+	std::unordered_map<olc::Renderable*, uint16_t> m_textureIndex;
+	olc::Renderable* m_lastTexture = nullptr;
+	uint16_t m_lastTextureIndex = 0;
+
+	// Entries of the list in draw order, for endBatch()
+	std::vector<const RenderBatchEntry*> m_ordered;
+
+	// Software target
+	olc::Sprite* m_target = nullptr;
+	olc::Renderable* m_placeholder = nullptr;
+	olc::TextureCache* m_textureCache = nullptr;
+	Filter m_filter = Filter::NEAREST;
+	std::vector<olc::Pixel> m_span;
+
+	// Tiled software target, see SetThreadPool()
+	olc::ThreadPool* m_pool = nullptr;
+	int m_tileSize = 64;
+	std::vector<RenderBatchEntry> m_rasterEntries;
+	std::vector<olc::vf2d> m_rasterCorners;
+	// Entry indices of each tile, tile n has m_binEntries[m_binStart[n] .. m_binStart[n + 1]]
+	std::vector<uint32_t> m_binStart;
+	std::vector<uint32_t> m_binEntries;
+	// Scratch row per thread
+	std::vector<std::vector<olc::Pixel>> m_spans;
 };
 } // namespace olc
 
@@ -258,6 +614,15 @@ namespace olc {
 
 		m_active = true;
 		m_drawables.clear();
+		m_compactEntries.clear();
+		m_spilled = false;
+		if (m_textures.size() > 0x8000) {
+			// Texture indices are only needed until End(), start over 
+			// before the table runs out of 16-bit indices
+			m_textures.clear();
+			m_textureIndex.clear();
+			m_lastTexture = nullptr;
+		}
 	}
 
 	void RenderBatch::End() 
@@ -265,15 +630,473 @@ namespace olc {
 		// Ensure that Begin() was called prior to End()
 		assert(m_active);
 
-		for (auto i = m_drawables.begin(); i != m_drawables.end(); ++i) {
+		if (m_compact && !m_spilled) {
+			sortCompact();
+			decodeCompact();
+			endBatch(DecodedSource{ m_decoded });
+		}
+		else {
+			m_ordered.clear();
+			m_ordered.reserve(m_drawables.size());
+			for (const RenderBatchEntry& entry : m_drawables) {
+				m_ordered.push_back(&entry);
+			}
+			endBatch(ListSource{ m_ordered });
+		}
+		m_active = false;
+	}
+
+	template<class Source>
+	void RenderBatch::endBatch(const Source& _source)
+	{
+		buildQuads(_source);
+
+		m_stats = Stats();
+		m_stats.entries = _source.size();
+		m_culled.clear();
+		if (m_occlusionCulling) {
+			cullOccluded(_source);
+		}
+		if (m_target != nullptr) {
+			rasterize(_source);
+			return;
+		}
+
+		// Texture coordinates for each combination of olc::Sprite::Flip
+		static const olc::vf2d uvs[4][4] = {
+			{ { 0.0f, 0.0f }, { 0.0f, 1.0f }, { 1.0f, 1.0f }, { 1.0f, 0.0f } },
+			{ { 1.0f, 0.0f }, { 1.0f, 1.0f }, { 0.0f, 1.0f }, { 0.0f, 0.0f } },
+			{ { 0.0f, 1.0f }, { 0.0f, 0.0f }, { 1.0f, 0.0f }, { 1.0f, 1.0f } },
+			{ { 1.0f, 1.0f }, { 1.0f, 0.0f }, { 0.0f, 0.0f }, { 0.0f, 1.0f } }
+		};
+
+		// Decal mode is only changed between runs of entries with different
+		// blend modes. The PGE is left in DecalMode::NORMAL afterwards.
+		bool modeSet = false;
+		olc::DecalMode mode = olc::DecalMode::NORMAL;
+		const olc::vf2d* corners = m_quadCorners.data();
+		const size_t count = _source.size();
+		for (size_t index = 0; index < count; ++index) {
+			const auto& e = _source.at(index);
+			if (!m_culled.empty() && m_culled[index]) {
+				if (e.transformed()) {
+					corners += 4;
+				}
+				continue;
+			}
+			if (!modeSet || e.mode != mode) {
+				mode = e.mode;
+				modeSet = true;
+				pge->SetDecalMode(mode);
+			}
+			olc::Renderable* renderable = lod(e.renderable, e.size);
+			if (e.transformed()) {
+				const olc::Pixel tints[4] = { e.tint, e.tint, e.tint, e.tint };
+				pge->DrawExplicitDecal(renderable->Decal(), corners, uvs[e.flip & 3], tints, 4);
+				corners += 4;
+				continue;
+			}
 			pge->DrawPartialDecal(
-				i->position,
-				i->size,
-				i->renderable->Decal(),
+				e.position,
+				e.size,
+				renderable->Decal(),
 				vi2d(0, 0),
-				vi2d(i->renderable->Sprite()->width, i->renderable->Sprite()->height));
+				vi2d(renderable->Sprite()->width, renderable->Sprite()->height),
+				e.tint);
 		}
-		m_active = false;
+		if (modeSet && mode != olc::DecalMode::NORMAL) {
+			pge->SetDecalMode(olc::DecalMode::NORMAL);
+		}
+	}
+
+	olc::vi2d RenderBatch::viewSize() const
+	{
+		if (m_target != nullptr) {
+			return olc::vi2d(m_target->width, m_target->height);
+		}
+		return olc::vi2d(pge->ScreenWidth(), pge->ScreenHeight());
+	}
+
+	void RenderBatch::SetThreadPool(olc::ThreadPool* _pool, int _tileSize)
+	{
+		assert(_tileSize > 0);
+		m_pool = _pool;
+		m_tileSize = _tileSize;
+	}
+
+	template<class Source>
+	void RenderBatch::rasterize(const Source& _source)
+	{
+		const Clip clip = { 0, 0, m_target->width, m_target->height };
+		const olc::vf2d* corners = m_quadCorners.data();
+		const size_t count = _source.size();
+		m_rasterEntries.clear();
+		m_rasterCorners.clear();
+
+		// Layers with dirty tracking only upload the areas written to, decal only
+		// layers are only shown when written to
+		int layer = -1;
+		if (pge != nullptr) {
+			const auto& layers = pge->GetLayers();
+			for (size_t n = 0; n < layers.size(); ++n) {
+				if (layers[n].pDrawTarget == m_target && (layers[n].bDirtyTracking || layers[n].bDecalOnly)) {
+					layer = (int)n;
+				}
+			}
+		}
+		for (size_t index = 0; index < count; ++index) {
+			const auto& e = _source.at(index);
+			const bool transformed = e.transformed();
+			const bool culled = !m_culled.empty() && m_culled[index];
+			if (!culled) {
+				olc::vf2d rect[4];
+				if (!transformed) {
+					// Same placement as DrawPartialDecal()
+					const float x = std::floor(e.position.x);
+					const float y = std::floor(e.position.y);
+					rect[0] = { x, y };
+					rect[1] = { x, y + e.size.y };
+					rect[2] = { x + e.size.x, y + e.size.y };
+					rect[3] = { x + e.size.x, y };
+				}
+				const olc::vf2d* quad = transformed ? corners : rect;
+				if (layer >= 0) {
+					markDirty((uint8_t)layer, quad);
+				}
+				if (m_pool != nullptr) {
+					m_rasterEntries.push_back(e);
+					m_rasterCorners.insert(m_rasterCorners.end(), quad, quad + 4);
+				}
+				else {
+					rasterizeEntry(e, quad, m_target, clip, m_filter, m_span);
+				}
+			}
+			if (transformed) {
+				corners += 4;
+			}
+		}
+		if (m_pool != nullptr) {
+			rasterizeTiles();
+		}
+	}
+
+	void RenderBatch::markDirty(uint8_t _layer, const olc::vf2d* _corners)
+	{
+		float minx = _corners[0].x, maxx = _corners[0].x, miny = _corners[0].y, maxy = _corners[0].y;
+		for (int n = 1; n < 4; ++n) {
+			minx = std::min(minx, _corners[n].x); maxx = std::max(maxx, _corners[n].x);
+			miny = std::min(miny, _corners[n].y); maxy = std::max(maxy, _corners[n].y);
+		}
+		// Outlines can touch the pixel at floor() of the maximum corner
+		const olc::vi2d pos((int)std::floor(minx), (int)std::floor(miny));
+		pge->MarkLayerDirty(_layer, pos, olc::vi2d((int)std::floor(maxx) + 1, (int)std::floor(maxy) + 1) - pos);
+	}
+
+	void RenderBatch::rasterizeTiles()
+	{
+		const int ts = m_tileSize;
+		const int tilesX = (m_target->width + ts - 1) / ts;
+		const int tilesY = (m_target->height + ts - 1) / ts;
+		const size_t entries = m_rasterEntries.size();
+
+		// Tile range of each entry, an outline can touch the pixel at 
+		// floor() of its maximum corner
+		auto tileRange = [&](size_t _entry, int& _tx0, int& _ty0, int& _tx1, int& _ty1) {
+			const olc::vf2d* c = &m_rasterCorners[_entry * 4];
+			float minx = c[0].x, maxx = c[0].x, miny = c[0].y, maxy = c[0].y;
+			for (int n = 1; n < 4; ++n) {
+				minx = std::min(minx, c[n].x); maxx = std::max(maxx, c[n].x);
+				miny = std::min(miny, c[n].y); maxy = std::max(maxy, c[n].y);
+			}
+			_tx0 = std::max(0, (int)std::floor(minx)) / ts;
+			_ty0 = std::max(0, (int)std::floor(miny)) / ts;
+			_tx1 = std::min(m_target->width - 1, (int)std::floor(maxx)) / ts;
+			_ty1 = std::min(m_target->height - 1, (int)std::floor(maxy)) / ts;
+			if (maxx < 0.0f || maxy < 0.0f) {
+				_tx1 = _tx0 - 1;
+			}
+		};
+
+		// Count, prefix sum and fill, entries stay in batch order per tile
+		m_binStart.assign((size_t)tilesX * tilesY + 1, 0);
+		for (size_t n = 0; n < entries; ++n) {
+			int tx0, ty0, tx1, ty1;
+			tileRange(n, tx0, ty0, tx1, ty1);
+			for (int ty = ty0; ty <= ty1; ++ty) {
+				for (int tx = tx0; tx <= tx1; ++tx) {
+					++m_binStart[(size_t)ty * tilesX + tx + 1];
+				}
+			}
+		}
+		for (size_t n = 1; n < m_binStart.size(); ++n) {
+			m_binStart[n] += m_binStart[n - 1];
+		}
+		m_binEntries.resize(m_binStart.back());
+		std::vector<uint32_t> cursor(m_binStart.begin(), m_binStart.end() - 1);
+		for (size_t n = 0; n < entries; ++n) {
+			int tx0, ty0, tx1, ty1;
+			tileRange(n, tx0, ty0, tx1, ty1);
+			for (int ty = ty0; ty <= ty1; ++ty) {
+				for (int tx = tx0; tx <= tx1; ++tx) {
+					m_binEntries[cursor[(size_t)ty * tilesX + tx]++] = (uint32_t)n;
+				}
+			}
+		}
+
+		m_spans.resize(m_pool->Size());
+		m_pool->ParallelFor((size_t)tilesX * tilesY, [&](size_t _tile, size_t _thread) {
+			const int tx = (int)(_tile % tilesX);
+			const int ty = (int)(_tile / tilesX);
+			const Clip clip = { tx * ts, ty * ts,
+				std::min(m_target->width, (tx + 1) * ts), std::min(m_target->height, (ty + 1) * ts) };
+			for (uint32_t n = m_binStart[_tile]; n < m_binStart[_tile + 1]; ++n) {
+				const uint32_t entry = m_binEntries[n];
+				rasterizeEntry(m_rasterEntries[entry], &m_rasterCorners[(size_t)entry * 4],
+					m_target, clip, m_filter, m_spans[_thread]);
+			}
+		});
+	}
+
+	void RenderBatch::rasterizeEntry(const RenderBatchEntry& _entry, const olc::vf2d* _corners,
+		olc::Sprite* _target, const Clip& _clip, Filter _filter, std::vector<olc::Pixel>& _span)
+	{
+		const olc::Sprite* sprite = _entry.renderable->Sprite();
+		if (sprite == nullptr || sprite->width <= 0 || sprite->height <= 0) {
+			return;
+		}
+		if (_entry.mode == olc::DecalMode::WIREFRAME) {
+			rasterizeOutline(_entry, _corners, _target, _clip);
+			return;
+		}
+		// Sampling a smaller mip level reads far less memory
+		const olc::Sprite* mip = lod(_entry.renderable, _entry.size)->Sprite();
+		if (!mip->pColData.empty()) {
+			sprite = mip;
+		}
+		// Pixels dropped after upload, see Renderable::SetKeepPixels()
+		if (sprite->pColData.empty()) {
+			return;
+		}
+
+		// Quad parameters s, t in 0..1 along the top and the left edge
+		const olc::vf2d c0 = _corners[0];
+		const olc::vf2d ex = _corners[3] - c0;
+		const olc::vf2d ey = _corners[1] - c0;
+		const float det = ex.x * ey.y - ex.y * ey.x;
+		if (std::fabs(det) < 1e-6f) {
+			return;
+		}
+		const float inv = 1.0f / det;
+		const float dsx = ey.y * inv, dsy = -ey.x * inv;
+		const float dtx = -ex.y * inv, dty = ex.x * inv;
+
+		float minx = c0.x, maxx = c0.x, miny = c0.y, maxy = c0.y;
+		for (int n = 1; n < 4; ++n) {
+			minx = std::min(minx, _corners[n].x); maxx = std::max(maxx, _corners[n].x);
+			miny = std::min(miny, _corners[n].y); maxy = std::max(maxy, _corners[n].y);
+		}
+		// Values along a row are computed from the left edge of the 
+		// unclipped bounds, so a pixel gets exactly the same result 
+		// no matter how the target is split into clip rectangles
+		const int ux0 = (int)std::floor(minx);
+		const int bx0 = std::max(_clip.x0, ux0);
+		const int bx1 = std::min(_clip.x1, (int)std::ceil(maxx));
+		const int by0 = std::max(_clip.y0, (int)std::floor(miny));
+		const int by1 = std::min(_clip.y1, (int)std::ceil(maxy));
+		if (bx0 >= bx1 || by0 >= by1) {
+			return;
+		}
+
+		// Texture coordinates in 16.16 texels, flips mirror s and t
+		const bool flipU = (_entry.flip & olc::Sprite::HORIZ) != 0;
+		const bool flipV = (_entry.flip & olc::Sprite::VERT) != 0;
+		const float tw = (float)sprite->width * 65536.0f;
+		const float th = (float)sprite->height * 65536.0f;
+		const float dux = (flipU ? -dsx : dsx) * tw;
+		const float dvx = (flipV ? -dtx : dtx) * th;
+		const int32_t maxTx = sprite->width - 1;
+		const int32_t maxTy = sprite->height - 1;
+		const olc::Pixel* texels = sprite->pColData.data();
+
+		// Narrows [_x0, _x1) to the pixels where a + b * (x - ux0) is in [0, 1)
+		auto inside = [ux0](float _a, float _b, int& _x0, int& _x1) {
+			if (_b == 0.0f) {
+				if (_a < 0.0f || _a >= 1.0f) {
+					_x1 = _x0;
+				}
+				return;
+			}
+			float lo = ux0 - _a / _b;
+			float hi = ux0 + (1.0f - _a) / _b;
+			if (lo > hi) {
+				std::swap(lo, hi);
+			}
+			_x0 = std::max(_x0, (int)std::ceil(lo));
+			_x1 = std::min(_x1, (int)std::ceil(hi));
+		};
+
+		_span.resize((size_t)(bx1 - bx0));
+		for (int y = by0; y < by1; ++y) {
+			// s and t at the centre of pixel (ux0, y)
+			const float px = ux0 + 0.5f - c0.x;
+			const float py = y + 0.5f - c0.y;
+			const float s = px * dsx + py * dsy;
+			const float t = px * dtx + py * dty;
+			int x0 = bx0, x1 = bx1;
+			inside(s, dsx, x0, x1);
+			inside(t, dtx, x0, x1);
+			if (x0 >= x1) {
+				continue;
+			}
+
+			// Texture position in 16.16 texels at pixel x is fu + dux * (x - ux0)
+			const float fu = (flipU ? 1.0f - s : s) * tw;
+			const float fv = (flipV ? 1.0f - t : t) * th;
+			olc::Pixel* out = _span.data();
+			if (_filter == Filter::NEAREST) {
+				for (int x = x0; x < x1; ++x) {
+					const float k = (float)(x - ux0);
+					const int32_t tx = std::min(std::max((int32_t)(fu + dux * k) >> 16, 0), maxTx);
+					const int32_t ty = std::min(std::max((int32_t)(fv + dvx * k) >> 16, 0), maxTy);
+					*out++ = texels[ty * sprite->width + tx];
+				}
+			}
+			else {
+				for (int x = x0; x < x1; ++x) {
+					// Texel centres are at +0.5, weights in 8 bits
+					const float k = (float)(x - ux0);
+					const int32_t su = (int32_t)(fu + dux * k) - 32768;
+					const int32_t sv = (int32_t)(fv + dvx * k) - 32768;
+					const uint32_t wx = (uint32_t)(su >> 8) & 0xFF;
+					const uint32_t wy = (uint32_t)(sv >> 8) & 0xFF;
+					const int32_t tx0 = std::min(std::max(su >> 16, 0), maxTx);
+					const int32_t tx1 = std::min(std::max((su >> 16) + 1, 0), maxTx);
+					const int32_t ty0 = std::min(std::max(sv >> 16, 0), maxTy);
+					const int32_t ty1 = std::min(std::max((sv >> 16) + 1, 0), maxTy);
+					const olc::Pixel* r0 = texels + ty0 * sprite->width;
+					const olc::Pixel* r1 = texels + ty1 * sprite->width;
+
+					// Two channels at a time in 0x00FF00FF lanes
+					auto lerp = [](uint32_t _a, uint32_t _b, uint32_t _w) {
+						const uint32_t rb = ((_a & 0x00FF00FF) * (256 - _w) + (_b & 0x00FF00FF) * _w) >> 8;
+						const uint32_t ag = (((_a >> 8) & 0x00FF00FF) * (256 - _w) + ((_b >> 8) & 0x00FF00FF) * _w) >> 8;
+						return (rb & 0x00FF00FF) | ((ag & 0x00FF00FF) << 8);
+					};
+					const uint32_t top = lerp(r0[tx0].n, r0[tx1].n, wx);
+					const uint32_t bottom = lerp(r1[tx0].n, r1[tx1].n, wx);
+					(out++)->n = lerp(top, bottom, wy);
+				}
+			}
+			blendSpan(_target->pColData.data() + (size_t)y * _target->width + x0,
+				_span.data(), x1 - x0, _entry.tint, _entry.mode);
+		}
+	}
+
+	void RenderBatch::rasterizeOutline(const RenderBatchEntry& _entry, const olc::vf2d* _corners,
+		olc::Sprite* _target, const Clip& _clip)
+	{
+		for (int n = 0; n < 4; ++n) {
+			const olc::vf2d a = _corners[n];
+			const olc::vf2d d = _corners[(n + 1) & 3] - a;
+			const int steps = std::max(1, (int)std::ceil(std::max(std::fabs(d.x), std::fabs(d.y))));
+			for (int i = 0; i <= steps; ++i) {
+				const int x = (int)std::floor(a.x + d.x * i / steps);
+				const int y = (int)std::floor(a.y + d.y * i / steps);
+				if (x >= _clip.x0 && x < _clip.x1 && y >= _clip.y0 && y < _clip.y1) {
+					_target->pColData[(size_t)y * _target->width + x] = _entry.tint;
+				}
+			}
+		}
+	}
+
+	void RenderBatch::blendSpan(olc::Pixel* _dst, const olc::Pixel* _src, int _count,
+		olc::Pixel _tint, olc::DecalMode _mode)
+	{
+		const bool tinted = _tint != olc::WHITE;
+		int i = 0;
+
+#if defined(OLC_RENDERBATCH_SSE2)
+		// 4 pixels per iteration, as 2 x 4 channels in 16-bit lanes
+		const __m128i zero = _mm_setzero_si128();
+		const __m128i half = _mm_set1_epi16(128);
+		const __m128i full = _mm_set1_epi16(255);
+		const __m128i alphaMask = _mm_set1_epi32((int)0xFF000000);
+		const __m128i tint16 = _mm_unpacklo_epi8(_mm_set1_epi32((int)_tint.n), zero);
+		// a * b / 255, rounded
+		auto mul16 = [half](__m128i _a, __m128i _b) {
+			const __m128i t = _mm_add_epi16(_mm_mullo_epi16(_a, _b), half);
+			return _mm_srli_epi16(_mm_add_epi16(t, _mm_srli_epi16(t, 8)), 8);
+		};
+		auto blend = [&](__m128i _s, __m128i _d) {
+			if (tinted) {
+				_s = mul16(_s, tint16);
+			}
+			const __m128i a = _mm_shufflehi_epi16(_mm_shufflelo_epi16(_s, 0xFF), 0xFF);
+			const __m128i ia = _mm_sub_epi16(full, a);
+			switch (_mode) {
+			case olc::DecalMode::ADDITIVE:
+				return _mm_add_epi16(mul16(_s, a), _d);
+			case olc::DecalMode::MULTIPLICATIVE:
+				return _mm_add_epi16(mul16(_s, _d), mul16(_d, ia));
+			case olc::DecalMode::STENCIL:
+				return mul16(_d, a);
+			case olc::DecalMode::ILLUMINATE:
+				return _mm_add_epi16(mul16(_s, ia), mul16(_d, a));
+			default:
+				return _mm_add_epi16(mul16(_s, a), mul16(_d, ia));
+			}
+		};
+		const bool skipClear = _mode == olc::DecalMode::NORMAL || _mode == olc::DecalMode::ADDITIVE;
+		const bool copyOpaque = _mode == olc::DecalMode::NORMAL && (!tinted || _tint.a == 255);
+		for (; i + 4 <= _count; i += 4) {
+			const __m128i s = _mm_loadu_si128((const __m128i*)(_src + i));
+			const __m128i alpha = _mm_and_si128(s, alphaMask);
+			if (skipClear && _mm_movemask_epi8(_mm_cmpeq_epi32(alpha, zero)) == 0xFFFF) {
+				continue;
+			}
+			if (copyOpaque && !tinted && _mm_movemask_epi8(_mm_cmpeq_epi32(alpha, alphaMask)) == 0xFFFF) {
+				_mm_storeu_si128((__m128i*)(_dst + i), s);
+				continue;
+			}
+			const __m128i d = _mm_loadu_si128((const __m128i*)(_dst + i));
+			const __m128i lo = blend(_mm_unpacklo_epi8(s, zero), _mm_unpacklo_epi8(d, zero));
+			const __m128i hi = blend(_mm_unpackhi_epi8(s, zero), _mm_unpackhi_epi8(d, zero));
+			_mm_storeu_si128((__m128i*)(_dst + i), _mm_packus_epi16(lo, hi));
+		}
+#endif
+
+		auto mul = [](uint32_t _a, uint32_t _b) {
+			const uint32_t t = _a * _b + 128;
+			return (t + (t >> 8)) >> 8;
+		};
+		for (; i < _count; ++i) {
+			uint32_t s[4] = { _src[i].r, _src[i].g, _src[i].b, _src[i].a };
+			const uint32_t d[4] = { _dst[i].r, _dst[i].g, _dst[i].b, _dst[i].a };
+			if (tinted) {
+				s[0] = mul(s[0], _tint.r); s[1] = mul(s[1], _tint.g);
+				s[2] = mul(s[2], _tint.b); s[3] = mul(s[3], _tint.a);
+			}
+			const uint32_t a = s[3], ia = 255 - a;
+			uint32_t o[4];
+			for (int c = 0; c < 4; ++c) {
+				switch (_mode) {
+				case olc::DecalMode::ADDITIVE: o[c] = mul(s[c], a) + d[c]; break;
+				case olc::DecalMode::MULTIPLICATIVE: o[c] = mul(s[c], d[c]) + mul(d[c], ia); break;
+				case olc::DecalMode::STENCIL: o[c] = mul(d[c], a); break;
+				case olc::DecalMode::ILLUMINATE: o[c] = mul(s[c], ia) + mul(d[c], a); break;
+				default: o[c] = mul(s[c], a) + mul(d[c], ia); break;
+				}
+			}
+			_dst[i] = olc::Pixel((uint8_t)std::min(o[0], 255u), (uint8_t)std::min(o[1], 255u),
+				(uint8_t)std::min(o[2], 255u), (uint8_t)std::min(o[3], 255u));
+		}
+	}
+
+	void RenderBatch::SetCompact(bool _enable)
+	{
+		// Entries can not be moved between the containers while drawing
+		assert(!m_active);
+		m_compact = _enable;
 	}
 
 	void RenderBatch::Draw(
@@ -285,6 +1108,7 @@ namespace olc {
 		// Ensure that Begin() was called and this RenderBatch is active
 		assert(m_active);
 
+		_renderable = drawable(_renderable);
 		if (_renderable != nullptr) {
 			RenderBatchEntry entry(
 				_renderable,
@@ -304,8 +1128,9 @@ namespace olc {
 		olc::Camera2D* _camera)
 	{
 		// Ensure that Begin() was called and this RenderBatch is active
-
 		assert(m_active);
+
+		_renderable = drawable(_renderable);
 		if (_renderable != nullptr) {
 			RenderBatchEntry entry(
 				_renderable,
@@ -317,33 +1142,471 @@ namespace olc {
 		}
 	}
 
-	void RenderBatch::insertBatchEntry(RenderBatchEntry& _entry, Camera2D* _camera) {
-		auto begin = m_drawables.begin();
-		auto end = m_drawables.end();
+	void RenderBatch::Draw(
+		olc::Renderable* _renderable,
+		const olc::vf2d& _pos,
+		const olc::vf2d& _size,
+		float _z,
+		const olc::Pixel& _tint,
+		olc::DecalMode _mode,
+		olc::Camera2D* _camera)
+	{
+		// Ensure that Begin() was called and this RenderBatch is active
+		assert(m_active);
+
+		_renderable = drawable(_renderable);
+		if (_renderable != nullptr) {
+			RenderBatchEntry entry(
+				_renderable,
+				_pos,
+				_size,
+				_z,
+				_tint,
+				_mode
+			);
+			insertBatchEntry(entry, _camera);
+		}
+	}
+
+	void RenderBatch::Draw(
+		olc::Renderable* _renderable,
+		const olc::vf2d& _pos,
+		float _scale,
+		float _z,
+		const olc::Pixel& _tint,
+		olc::DecalMode _mode,
+		olc::Camera2D* _camera)
+	{
+		// Ensure that Begin() was called and this RenderBatch is active
+		assert(m_active);
+
+		_renderable = drawable(_renderable);
+		if (_renderable != nullptr) {
+			RenderBatchEntry entry(
+				_renderable,
+				_pos,
+				olc::vf2d(_renderable->Sprite()->width * _scale, _renderable->Sprite()->height * _scale),
+				_z,
+				_tint,
+				_mode
+			);
+			insertBatchEntry(entry, _camera);
+		}
+	}
+
+	void RenderBatch::Draw(
+		olc::Renderable* _renderable,
+		const olc::vf2d& _pos,
+		const olc::vf2d& _scale,
+		float _angle,
+		const olc::vf2d& _origin,
+		float _z,
+		uint8_t _flip,
+		const olc::Pixel& _tint,
+		olc::DecalMode _mode,
+		olc::Camera2D* _camera)
+	{
+		// Ensure that Begin() was called and this RenderBatch is active
+		assert(m_active);
+
+		_renderable = drawable(_renderable);
+		if (_renderable != nullptr) {
+			olc::vf2d size(_renderable->Sprite()->width * _scale.x, _renderable->Sprite()->height * _scale.y);
+			olc::vf2d origin(_origin * _scale);
+			if (_angle == 0.0f && _flip == olc::Sprite::NONE) {
+				// Plain axis aligned quad, keep it on the cheaper path
+				RenderBatchEntry entry(_renderable, _pos - origin, size, _z, _tint, _mode);
+				insertBatchEntry(entry, _camera);
+			}
+			else {
+				RenderBatchEntry entry(_renderable, _pos, size, _z, _tint, _mode, _angle, origin, _flip);
+				insertBatchEntry(entry, _camera);
+			}
+		}
+	}
+
+	template<class Source>
+	void RenderBatch::buildQuads(const Source& _source)
+	{
+		// Gather inputs of the transformed entries, one row of 
+		// { x, y, -ox, -oy, w - ox, h - oy, angle } per entry
+		constexpr size_t KStride = 7;
+		m_quadIn.clear();
+		for (size_t index = 0; index < _source.size(); ++index) {
+			const auto& e = _source.at(index);
+			if (e.transformed()) {
+				const float in[KStride] = { e.position.x, e.position.y,
+					-e.origin.x, -e.origin.y, 
+					e.size.x - e.origin.x, e.size.y - e.origin.y, e.angle };
+				m_quadIn.insert(m_quadIn.end(), in, in + KStride);
+			}
+		}
+
+		const size_t count = m_quadIn.size() / KStride;
+		m_quadCorners.resize(count * 4);
+		if (count == 0) {
+			return;
+		}
+
+		// sin/cos once per entry, either exact or from the lookup table.
+		// The angle slot of each row is replaced with sin, cos goes to a 
+		// separate array.
+		m_quadCosines.resize(count);
+		float* cosines = m_quadCosines.data();
+		float* in = m_quadIn.data();
+		if (m_rotationMode == RotationMode::FAST) {
+			const float* table = sinTable();
+			constexpr float KToIndex = 4096.0f / 6.28318530718f;
+			for (size_t n = 0; n < count; ++n) {
+				const int index = (int)std::lround(in[n * KStride + 6] * KToIndex);
+				in[n * KStride + 6] = table[index & 4095];
+				cosines[n] = table[(index + 1024) & 4095];
+			}
+		}
+		else {
+			for (size_t n = 0; n < count; ++n) {
+				const float a = in[n * KStride + 6];
+				in[n * KStride + 6] = std::sin(a);
+				cosines[n] = std::cos(a);
+			}
+		}
+
+		// Rotate the local corners and translate to the origin position
+		olc::vf2d* out = m_quadCorners.data();
+		for (size_t n = 0; n < count; ++n) {
+			const float* e = in + n * KStride;
+			const float s = e[6], c = cosines[n];
+			const float x0c = e[2] * c, x0s = e[2] * s, x1c = e[4] * c, x1s = e[4] * s;
+			const float y0c = e[3] * c, y0s = e[3] * s, y1c = e[5] * c, y1s = e[5] * s;
+			out[n * 4 + 0] = { e[0] + x0c - y0s, e[1] + x0s + y0c };
+			out[n * 4 + 1] = { e[0] + x0c - y1s, e[1] + x0s + y1c };
+			out[n * 4 + 2] = { e[0] + x1c - y1s, e[1] + x1s + y1c };
+			out[n * 4 + 3] = { e[0] + x1c - y0s, e[1] + x1s + y0c };
+		}
+	}
+
+	void RenderBatch::ScanOpacity(olc::Renderable* _renderable)
+	{
+		if (_renderable != nullptr) {
+			m_opaque[_renderable] = { _renderable->ImageId(), IsOpaque(_renderable->Sprite()) };
+		}
+	}
 
+	bool RenderBatch::IsOpaque(const olc::Sprite* _sprite)
+	{
+		if (_sprite == nullptr || _sprite->pColData.empty()) {
+			return false;
+		}
+		// AND all pixels of a row together, the loop has no branches and 
+		// vectorizes. Bail out at the first row with any transparency.
+		const uint32_t* data = reinterpret_cast<const uint32_t*>(_sprite->pColData.data());
+		for (int32_t y = 0; y < _sprite->height; ++y) {
+			const uint32_t* row = data + (size_t)y * _sprite->width;
+			uint32_t acc = 0xFFFFFFFF;
+			for (int32_t x = 0; x < _sprite->width; ++x) {
+				acc &= row[x];
+			}
+			if ((acc >> 24) != 0xFF) {
+				return false;
+			}
+		}
+		return true;
+	}
+
+	template<class Source>
+	void RenderBatch::cullOccluded(const Source& _source)
+	{
+		const olc::vi2d view = viewSize();
+		const int sw = view.x;
+		const int sh = view.y;
+		const int cw = (sw + KCoverageCell - 1) / KCoverageCell;
+		const int ch = (sh + KCoverageCell - 1) / KCoverageCell;
+		m_coverage.assign((size_t)cw * ch, 0);
+		m_culled.assign(_source.size(), 0);
+
+		double areaAll = 0.0;
+		double areaDrawn = 0.0;
+		size_t culled = 0;
+
+		// Walk front to back, the corners of transformed entries are 
+		// consumed from the end of m_quadCorners
+		const olc::vf2d* corners = m_quadCorners.data() + m_quadCorners.size();
+		for (size_t index = _source.size(); index-- > 0; ) {
+			const auto& e = _source.at(index);
+
+			// Screen bounds, DrawPartialDecal() floors the position
+			float x0, y0, x1, y1;
+			if (e.transformed()) {
+				corners -= 4;
+				x0 = x1 = corners[0].x;
+				y0 = y1 = corners[0].y;
+				for (int n = 1; n < 4; ++n) {
+					x0 = std::min(x0, corners[n].x); x1 = std::max(x1, corners[n].x);
+					y0 = std::min(y0, corners[n].y); y1 = std::max(y1, corners[n].y);
+				}
+			}
+			else {
+				// A negative scale mirrors the entry, its size is negative
+				const float fx = std::floor(e.position.x);
+				const float fy = std::floor(e.position.y);
+				x0 = std::min(fx, fx + e.size.x); x1 = std::max(fx, fx + e.size.x);
+				y0 = std::min(fy, fy + e.size.y); y1 = std::max(fy, fy + e.size.y);
+			}
+
+			// Pixels possibly touched, clipped to the screen
+			const int px0 = std::max(0, (int)std::floor(x0));
+			const int py0 = std::max(0, (int)std::floor(y0));
+			const int px1 = std::min(sw, (int)std::ceil(x1));
+			const int py1 = std::min(sh, (int)std::ceil(y1));
+			if (px0 >= px1 || py0 >= py1) {
+				m_culled[index] = 1;
+				++culled;
+				continue;
+			}
+			const double area = (double)(px1 - px0) * (py1 - py0);
+			areaAll += area;
+
+			// Hidden if every cell it touches is already fully covered
+			const int cx0 = px0 / KCoverageCell, cx1 = (px1 - 1) / KCoverageCell;
+			const int cy0 = py0 / KCoverageCell, cy1 = (py1 - 1) / KCoverageCell;
+			bool hidden = true;
+			for (int cy = cy0; cy <= cy1 && hidden; ++cy) {
+				for (int cx = cx0; cx <= cx1; ++cx) {
+					if (!m_coverage[(size_t)cy * cw + cx]) {
+						hidden = false;
+						break;
+					}
+				}
+			}
+			if (hidden) {
+				m_culled[index] = 1;
+				++culled;
+				continue;
+			}
+			areaDrawn += area;
+
+			// Can this entry hide the ones behind it?
+			if (e.transformed() || e.mode != olc::DecalMode::NORMAL || e.tint.a != 255) {
+				continue;
+			}
+			Opacity& opacity = m_opaque[e.renderable];
+			if (opacity.image != e.renderable->ImageId()) {
+				opacity = { e.renderable->ImageId(), IsOpaque(e.renderable->Sprite()) };
+			}
+			if (!opacity.opaque) {
+				continue;
+			}
+
+			// Mark the cells which are completely inside, cells on the 
+			// screen edges only need to be covered up to the edge
+			const int ox0 = std::max(0, (int)std::ceil(x0));
+			const int oy0 = std::max(0, (int)std::ceil(y0));
+			const int ox1 = std::min(sw, (int)std::floor(x1));
+			const int oy1 = std::min(sh, (int)std::floor(y1));
+			for (int cy = oy0 / KCoverageCell; cy <= cy1; ++cy) {
+				const int top = cy * KCoverageCell;
+				const int bottom = std::min(sh, top + KCoverageCell);
+				if (top < oy0 || bottom > oy1) {
+					continue;
+				}
+				for (int cx = ox0 / KCoverageCell; cx <= cx1; ++cx) {
+					const int left = cx * KCoverageCell;
+					const int right = std::min(sw, left + KCoverageCell);
+					if (left >= ox0 && right <= ox1) {
+						m_coverage[(size_t)cy * cw + cx] = 1;
+					}
+				}
+			}
+		}
+
+		const double screen = (double)sw * sh;
+		m_stats.culled = culled;
+		m_stats.overdraw = screen > 0.0 ? (float)(areaAll / screen) : 0.0f;
+		m_stats.overdrawCulled = screen > 0.0 ? (float)(areaDrawn / screen) : 0.0f;
+	}
+
+	const float* RenderBatch::sinTable()
+	{
+		static const std::vector<float> table = []() {
+			std::vector<float> t(4096);
+			for (size_t n = 0; n < t.size(); ++n) {
+				t[n] = (float)std::sin((double)n * 6.283185307179586 / 4096.0);
+			}
+			return t;
+		}();
+		return table.data();
+	}
+
+	void RenderBatch::insertBatchEntry(RenderBatchEntry& _entry, Camera2D* _camera) {
 		olc::vf2d tpos(_entry.position);
 		if (_camera != nullptr) {
 			tpos = translatePosition(tpos, *_camera);
 		}
 		_entry.position = tpos;
 
+		if (m_compact && !m_spilled) {
+			if (hasTextureIndex(_entry.renderable) && fitsCompact(_entry)) {
+				m_compactEntries.push_back(encode(_entry));
+				return;
+			}
+			spillCompact();
+		}
+		insertListEntry(_entry);
+	}
+
+	void RenderBatch::insertListEntry(const RenderBatchEntry& _entry)
+	{
+		auto begin = m_drawables.begin();
+		auto end = m_drawables.end();
 		if (m_order == DrawOrder::Z_INC) {
 			while ((begin != end) && ((*begin).z > _entry.z)) {
 				++begin;
 			}
-			m_drawables.insert(begin, _entry);
+			m_drawables.insert(sameModeInRun(begin, _entry), _entry);
 		}
 		else if (m_order == DrawOrder::Z_DECR) {
 			while ((begin != end) && ((*begin).z < _entry.z)) {
 				++begin;
 			}
-			m_drawables.insert(begin, _entry);
+			m_drawables.insert(sameModeInRun(begin, _entry), _entry);
 		}
 		else {
 			m_drawables.push_back(_entry);
 		}
 	}
 
+	std::list<RenderBatchEntry>::iterator RenderBatch::sameModeInRun(
+		std::list<RenderBatchEntry>::iterator _first, const RenderBatchEntry& _entry)
+	{
+		// Equal Z entries are drawn newest first. A new entry goes in front
+		// of the newest one with the same blend mode, if any, so the run 
+		// stays grouped by mode and the mode is changed less often.
+		for (auto i = _first; i != m_drawables.end() && i->z == _entry.z; ++i) {
+			if (i->mode == _entry.mode) {
+				return i;
+			}
+		}
+		return _first;
+	}
+
+	bool RenderBatch::fitsCompact(const RenderBatchEntry& _entry) const
+	{
+		// The range of an int16_t in 1/8 pixels
+		constexpr float KLimit = 32767.5f / (float)(1 << KFixedShift);
+		auto fits = [](float _value) { return _value > -KLimit - 0.125f && _value < KLimit; };
+		return fits(_entry.position.x - m_compactOrigin.x) && fits(_entry.position.y - m_compactOrigin.y) &&
+			fits(_entry.size.x) && fits(_entry.size.y) && fits(_entry.origin.x) && fits(_entry.origin.y) &&
+			_entry.z >= std::min(m_zMin, m_zMax) && _entry.z <= std::max(m_zMin, m_zMax);
+	}
+
+	RenderBatchCompactEntry RenderBatch::encode(const RenderBatchEntry& _entry)
+	{
+		constexpr float KToFixed = (float)(1 << KFixedShift);
+		constexpr float KToTurns = 65536.0f / 6.28318530718f;
+		auto fixed = [](float _value) -> int16_t {
+			const long v = std::lround(_value * KToFixed);
+			return (int16_t)std::max(-32768L, std::min(32767L, v));
+		};
+
+		const float zrange = m_zMax - m_zMin;
+		const float zt = zrange != 0.0f ? (_entry.z - m_zMin) / zrange : 0.0f;
+
+		RenderBatchCompactEntry c;
+		c.texture = textureIndex(_entry.renderable);
+		c.z = (uint16_t)std::lround(std::max(0.0f, std::min(1.0f, zt)) * 65535.0f);
+		c.x = fixed(_entry.position.x - m_compactOrigin.x);
+		c.y = fixed(_entry.position.y - m_compactOrigin.y);
+		c.w = fixed(_entry.size.x);
+		c.h = fixed(_entry.size.y);
+		c.ox = fixed(_entry.origin.x);
+		c.oy = fixed(_entry.origin.y);
+		c.angle = (int16_t)(uint16_t)(std::llround(_entry.angle * KToTurns) & 0xFFFF);
+		c.mode = (uint8_t)_entry.mode;
+		c.flip = _entry.flip;
+		c.tint = _entry.tint.n;
+		return c;
+	}
+
+	RenderBatchEntry RenderBatch::decode(const RenderBatchCompactEntry& _entry) const
+	{
+		constexpr float KToFloat = 1.0f / (float)(1 << KFixedShift);
+		constexpr float KToRadians = 6.28318530718f / 65536.0f;
+		return RenderBatchEntry(
+			m_textures[_entry.texture],
+			olc::vf2d(m_compactOrigin.x + _entry.x * KToFloat, m_compactOrigin.y + _entry.y * KToFloat),
+			olc::vf2d(_entry.w * KToFloat, _entry.h * KToFloat),
+			m_zMin + _entry.z * ((m_zMax - m_zMin) / 65535.0f),
+			olc::Pixel(_entry.tint),
+			(olc::DecalMode)_entry.mode,
+			_entry.angle * KToRadians,
+			olc::vf2d(_entry.ox * KToFloat, _entry.oy * KToFloat),
+			_entry.flip);
+	}
+
+	void RenderBatch::spillCompact()
+	{
+		// Same order as if the entries had been drawn in list mode, only 
+		// the quantization stays
+		m_spilled = true;
+		m_drawables.clear();
+		for (const RenderBatchCompactEntry& c : m_compactEntries) {
+			insertListEntry(decode(c));
+		}
+		m_compactEntries.clear();
+	}
+
+	uint16_t RenderBatch::textureIndex(olc::Renderable* _renderable)
+	{
+		// Consecutive draws of the same Renderable are the common case
+		if (_renderable == m_lastTexture) {
+			return m_lastTextureIndex;
+		}
+		auto found = m_textureIndex.find(_renderable);
+		if (found == m_textureIndex.end()) {
+			// insertBatchEntry() checks hasTextureIndex() first
+			assert(m_textures.size() < KMaxTextures);
+			found = m_textureIndex.emplace(_renderable, (uint16_t)m_textures.size()).first;
+			m_textures.push_back(_renderable);
+		}
+		m_lastTexture = _renderable;
+		m_lastTextureIndex = found->second;
+		return found->second;
+	}
+
+	void RenderBatch::sortCompact()
+	{
+		const size_t count = m_compactEntries.size();
+		m_compactOrder.resize(count);
+		if (m_order == DrawOrder::UNORDERED) {
+			for (size_t n = 0; n < count; ++n) {
+				m_compactOrder[n] = (uint32_t)n;
+			}
+			return;
+		}
+
+		// Key is { Z bucket in draw order : 16, blend mode : 8, ~index : 32 },
+		// deeper entries come first, newer ones first within a bucket and mode
+		m_sortKeys.resize(count);
+		for (size_t n = 0; n < count; ++n) {
+			const RenderBatchCompactEntry& c = m_compactEntries[n];
+			const uint64_t z = m_order == DrawOrder::Z_INC ? 0xFFFFu - c.z : c.z;
+			m_sortKeys[n] = (z << 40) | ((uint64_t)c.mode << 32) | (uint64_t)(0xFFFFFFFFu - (uint32_t)n);
+		}
+		std::sort(m_sortKeys.begin(), m_sortKeys.end());
+		for (size_t n = 0; n < count; ++n) {
+			m_compactOrder[n] = 0xFFFFFFFFu - (uint32_t)(m_sortKeys[n] & 0xFFFFFFFFu);
+		}
+	}
+
+	void RenderBatch::decodeCompact()
+	{
+		m_decoded.clear();
+		m_decoded.reserve(m_compactOrder.size());
+		for (uint32_t index : m_compactOrder) {
+			m_decoded.push_back(decode(m_compactEntries[index]));
+		}
+	}
+
 	olc::vf2d RenderBatch::translatePosition(const olc::vf2d& _pos, const Camera2D& camera) {
 		olc::vf2d pos(_pos - camera.Position());
 		return pos;
@@ -13,6 +13,12 @@
 
 #define OLC_PGEX_RENDERBATCH
 #include "RenderBatch.h"
+#define OLC_PGEX_SCENEGRAPH
+#include "SceneGraph.h"
+#define OLC_PGEX_ASYNCLOADER
+#include "AsyncLoader.h"
+#define OLC_PGEX_FRAMEPROFILER
+#include "FrameProfiler.h"
 #include "DebugLogger.h"
 
 class RenderableSprite
@@ -45,10 +51,32 @@ public:
 	bool OnUserCreate() override
 	{
 		LOG_INFO() << "PGEApplication::OnUserCreate() initializing";
-		m_background.Load("Assets\\desert.png");
-		m_Ball.Load("Assets\\ball.png");
+		// Decode both images at the same time on the pool. The ball is mostly 
+		// drawn scaled down, so it gets mipmaps
+		m_Ball.SetMipmaps(true);
+		m_loader.Load(&m_background, "Assets\\desert.png");
+		m_loader.Load(&m_Ball, "Assets\\ball.png");
+		m_loader.Wait();
 		m_RenderBatch.SetOrder(olc::RenderBatch::DrawOrder::Z_INC);
+		m_RenderBatch.SetOcclusionCulling(true);
+		m_RenderBatch.ScanOpacity(&m_background);
+		m_RenderBatch.ScanOpacity(&m_Ball);
+		m_RenderBatch.SetThreadPool(&m_threads);
+		EnableLayerDirtyTracking(0, true);
+		SetLayerDecalOnly(0, true);
 		m_camera.Set(olc::vf2d(0.0f, 0.0f));
+		m_profiler.SetRenderBatch(&m_RenderBatch);
+
+		// A small composite, two balls orbiting a bigger one
+		float sw = ((float)m_Ball.Sprite()->width);
+		float sh = ((float)m_Ball.Sprite()->height);
+		olc::vf2d center(sw / 2, sh / 2);
+		m_orbitRoot = m_scene.AddNode(olc::SceneGraph::KNoParent, olc::vf2d(200.0f, 200.0f), 0.0f, olc::vf2d(0.4f, 0.4f));
+		m_scene.SetSprite(m_orbitRoot, &m_Ball, 0.35f, center);
+		for (int i = 0; i < 2; ++i) {
+			olc::SceneGraph::NodeId moon = m_scene.AddNode(m_orbitRoot, olc::vf2d(i == 0 ? sw : -sw, 0.0f), 0.0f, olc::vf2d(0.5f, 0.5f));
+			m_scene.SetSprite(moon, &m_Ball, 0.2f, center, olc::Pixel(160, 160, 255));
+		}
 		return true;
 	}
 
@@ -56,6 +84,16 @@ public:
 	{
 		olc::vi2d mpos(GetMousePos());
 
+		if (GetKey(olc::Key::C).bPressed) {
+			m_RenderBatch.SetCompact(!m_RenderBatch.Compact());
+		}
+		if (GetKey(olc::Key::S).bPressed) {
+			// Software rendering into the draw target of layer 0
+			m_RenderBatch.SetTarget(m_RenderBatch.GetTarget() ? nullptr : GetDrawTarget());
+		}
+		if (GetKey(olc::Key::P).bPressed) {
+			m_profiler.SetOverlay(!m_profiler.Overlay());
+		}
 		m_RenderBatch.Begin();
 		m_RenderBatch.Draw(
 			&m_background,
@@ -108,10 +146,35 @@ public:
 			0.5f,
 			0.1f
 			);
+		m_angle += fElapsedTime;
+		m_RenderBatch.Draw(
+			&m_Ball,
+			olc::vf2d(rw / 2, rh / 2),
+			olc::vf2d(0.5f, 0.5f),
+			m_angle,
+			olc::vf2d(sw, sh),
+			0.3f,
+			olc::Sprite::HORIZ,
+			olc::Pixel(255, 160, 160),
+			olc::DecalMode::NORMAL,
+			&m_camera
+		);
+		m_scene.SetRotation(m_orbitRoot, m_angle * 2.0f);
+		m_scene.Draw(m_RenderBatch, &m_camera);
 		m_RenderBatch.End();
 
-		std::string fpss = "FPS: " + std::to_string(GetFPS());
+		const olc::FrameProfiler::Report frames = m_profiler.GetReport();
+		std::string fpss = "FPS: " + std::to_string(GetFPS()) +
+			" upload: " + std::to_string(GetLayerUploadBytes() / 1024) + " KB" +
+			" update p99: " + std::to_string(frames.p99) + " ms max: " + std::to_string(frames.max) + " ms (P)";
 		DrawStringDecal(olc::vf2d(10.0f, 10.0f), fpss);
+		const olc::RenderBatch::Stats& stats = m_RenderBatch.GetStats();
+		std::string statss = "Sprites: " + std::to_string(stats.entries) + 
+			" culled: " + std::to_string(stats.culled) + 
+			" overdraw: " + std::to_string(stats.overdraw) + " -> " + std::to_string(stats.overdrawCulled) +
+			(m_RenderBatch.Compact() ? " (compact, C)" : " (C)") +
+			(m_RenderBatch.GetTarget() ? " (software, S)" : " (S)");
+		DrawStringDecal(olc::vf2d(10.0f, 20.0f), statss);
 
 		olc::vf2d delta(0.0f, 0.0f);
 		if(GetKey(olc::Key::LEFT).bHeld) {
@@ -146,10 +209,18 @@ private:
 	olc::Renderable m_Ball;
 	olc::Camera2D m_camera;
 	olc::vf2d m_prevMousePos;
+	float m_angle = 0.0f;
+	olc::SceneGraph m_scene;
+	olc::SceneGraph::NodeId m_orbitRoot = 0;
+	olc::ThreadPool m_threads;
+	olc::AsyncLoader m_loader{ m_threads };
+	olc::FrameProfiler m_profiler;
 };
 
 int main()
 {
+	// Log messages are written by a background thread, not the game loop
+	DebugLogger::StartAsync();
 	PGEApplication demo;
 	if (demo.Construct(1024, 768, 1, 1))
 		demo.Start();
@@ -0,0 +1,295 @@
+/*
+	SceneGraph.h
+	+-------------------------------------------------------------+
+	|         OneLoneCoder Pixel Game Engine Extension            |
+	|                SceneGraph - v0.1.0                          |
+	+-------------------------------------------------------------+
+
+	What is this?
+	~~~~~~~~~~~~~
+	A lightweight transform hierarchy for RenderBatch. Nodes have a 
+	position, rotation and scale relative to their parent. All node data
+	is kept in flat arrays where a parent is always stored before its 
+	children, so updating the world transforms is a single linear pass 
+	which only recomputes nodes whose own transform or one of whose
+	ancestors changed.
+
+	Nodes with a Renderable attached are emitted into a RenderBatch with
+	one call to Draw(), in node order.
+
+	Scale is applied per axis before rotation. A non-uniform scale on a
+	parent combined with a rotated child cannot be represented by a 
+	rotated sprite, in that case children use the combined axis scales.
+
+	For example on how to use, see RenderBatchDemo.cpp.
+
+
+	License (OLC-3)
+	~~~~~~~~~~~~~~~
+
+	Copyright 2018 - 2021 OneLoneCoder.com
+
+	Redistribution and use in source and binary forms, with or without modification,
+	are permitted provided that the following conditions are met:
+
+	1. Redistributions or derivations of source code must retain the above copyright
+	notice, this list of conditions and the following disclaimer.
+
+	2. Redistributions or derivative works in binary form must reproduce the above
+	copyright notice. This list of conditions and the following	disclaimer must be
+	reproduced in the documentation and/or other materials provided with the distribution.
+
+	3. Neither the name of the copyright holder nor the names of its contributors may
+	be used to endorse or promote products derived from this software without specific
+	prior written permission.
+
+	THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS	"AS IS" AND ANY
+	EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+	OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+	SHALL THE COPYRIGHT	HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+	INCIDENTAL,	SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+	TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+	BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+	CONTRACT, STRICT LIABILITY, OR TORT	(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+	ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+	SUCH DAMAGE.
+
+	Links
+	~~~~~
+	Homepage:	https://github.com/codesmith-fi
+	Mail:		codesmith.fi@gmail.com
+
+	Author
+	~~~~~~
+	Erno Pakarinen (aka xanaki#9472 in discord, aka codesmith-fi)
+
+*/
+
+#ifndef __SCENEGRAPH_H_DEFINED__
+#define __SCENEGRAPH_H_DEFINED__
+
+#include <vector>
+#include <cstdint>
+#include <cmath>
+#include <algorithm>
+#include <assert.h>
+
+#include "RenderBatch.h"
+
+namespace olc {
+
+class SceneGraph
+{
+public: // Types
+	typedef uint32_t NodeId;
+	static constexpr NodeId KNoParent = 0xFFFFFFFF;
+
+public:
+	SceneGraph() = default;
+	virtual ~SceneGraph() = default;
+
+	/// Add a new node as the last node of the graph. The parent must already
+	/// exist, which keeps the arrays in topological order.
+	NodeId AddNode(NodeId _parent = KNoParent, 
+		const olc::vf2d& _pos = olc::vf2d(0.0f, 0.0f), float _rotation = 0.0f, 
+		const olc::vf2d& _scale = olc::vf2d(1.0f, 1.0f));
+
+	/// Attach a Renderable to a node. _origin is the pivot in sprite pixels,
+	/// the pivot is placed on the node's world position.
+	void SetSprite(NodeId _node, olc::Renderable* _renderable, float _z,
+		const olc::vf2d& _origin = olc::vf2d(0.0f, 0.0f),
+		const olc::Pixel& _tint = olc::WHITE, 
+		olc::DecalMode _mode = olc::DecalMode::NORMAL,
+		uint8_t _flip = olc::Sprite::NONE);
+
+	/// Parent relative transform, setting any of these marks the subtree dirty
+	void SetPosition(NodeId _node, const olc::vf2d& _pos);
+	void SetRotation(NodeId _node, float _rotation);
+	void SetScale(NodeId _node, const olc::vf2d& _scale);
+	inline const olc::vf2d Position(NodeId _node) const { return olc::vf2d(m_local[_node].x, m_local[_node].y); }
+	inline float Rotation(NodeId _node) const { return m_local[_node].rotation; }
+	inline const olc::vf2d Scale(NodeId _node) const { return olc::vf2d(m_local[_node].sx, m_local[_node].sy); }
+
+	/// World transform, valid after Update()
+	inline const olc::vf2d WorldPosition(NodeId _node) const { return olc::vf2d(m_world[_node].x, m_world[_node].y); }
+	inline float WorldRotation(NodeId _node) const { return m_world[_node].rotation; }
+	inline const olc::vf2d WorldScale(NodeId _node) const { return olc::vf2d(m_world[_node].sx, m_world[_node].sy); }
+
+	/// Hide or show a node, hidden nodes still update their transforms
+	inline void SetVisible(NodeId _node, bool _visible) { m_sprites[_node].visible = _visible; }
+
+	/// Recompute the world transforms of all dirty nodes and their subtrees
+	void Update();
+
+	/// Emit all visible nodes having a Renderable into the batch. Calls 
+	/// Update() first if anything is dirty.
+	void Draw(olc::RenderBatch& _batch, olc::Camera2D* _camera = nullptr);
+
+	inline size_t Size() const { return m_parent.size(); }
+	void Clear();
+
+private: // Types
+	struct Transform {
+		float x, y;
+		float rotation;
+		float sx, sy;
+	};
+	struct WorldTransform {
+		float x, y;
+		float rotation;
+		float sx, sy;
+		float sin, cos;
+	};
+	struct SpriteData {
+		olc::Renderable* renderable;
+		olc::vf2d origin;
+		float z;
+		olc::Pixel tint;
+		olc::DecalMode mode;
+		uint8_t flip;
+		bool visible;
+	};
+
+private:
+	inline void markDirty(NodeId _node) {
+		m_dirty[_node] = 1;
+		if (_node < m_firstDirty) {
+			m_firstDirty = _node;
+		}
+	}
+
+private: // Data
+	// All arrays are indexed by NodeId, parents come before their children
+	std::vector<NodeId> m_parent;
+	std::vector<Transform> m_local;
+	std::vector<WorldTransform> m_world;
+	std::vector<uint8_t> m_dirty;
+	std::vector<SpriteData> m_sprites;
+	// Lowest dirty node, nothing before it needs to be visited in Update()
+	NodeId m_firstDirty = KNoParent;
+};
+} // namespace olc
+
+#ifdef OLC_PGEX_SCENEGRAPH
+#undef OLC_PGEX_SCENEGRAPH
+
+namespace olc {
+	SceneGraph::NodeId SceneGraph::AddNode(NodeId _parent, const olc::vf2d& _pos, float _rotation, const olc::vf2d& _scale)
+	{
+		const NodeId id = (NodeId)m_parent.size();
+		// Parent must exist, this keeps the parent before its children
+		assert(_parent == KNoParent || _parent < id);
+
+		m_parent.push_back(_parent);
+		m_local.push_back({ _pos.x, _pos.y, _rotation, _scale.x, _scale.y });
+		m_world.push_back({ 0.0f, 0.0f, 0.0f, 1.0f, 1.0f, 0.0f, 1.0f });
+		m_dirty.push_back(0);
+		m_sprites.push_back({ nullptr, olc::vf2d(0.0f, 0.0f), 0.0f, olc::WHITE, olc::DecalMode::NORMAL, olc::Sprite::NONE, true });
+		markDirty(id);
+		return id;
+	}
+
+	void SceneGraph::SetSprite(NodeId _node, olc::Renderable* _renderable, float _z,
+		const olc::vf2d& _origin, const olc::Pixel& _tint, olc::DecalMode _mode, uint8_t _flip)
+	{
+		SpriteData& sprite = m_sprites[_node];
+		sprite.renderable = _renderable;
+		sprite.origin = _origin;
+		sprite.z = _z;
+		sprite.tint = _tint;
+		sprite.mode = _mode;
+		sprite.flip = _flip;
+	}
+
+	void SceneGraph::SetPosition(NodeId _node, const olc::vf2d& _pos)
+	{
+		m_local[_node].x = _pos.x;
+		m_local[_node].y = _pos.y;
+		markDirty(_node);
+	}
+
+	void SceneGraph::SetRotation(NodeId _node, float _rotation)
+	{
+		m_local[_node].rotation = _rotation;
+		markDirty(_node);
+	}
+
+	void SceneGraph::SetScale(NodeId _node, const olc::vf2d& _scale)
+	{
+		m_local[_node].sx = _scale.x;
+		m_local[_node].sy = _scale.y;
+		markDirty(_node);
+	}
+
+	void SceneGraph::Update()
+	{
+		const NodeId count = (NodeId)m_parent.size();
+		for (NodeId n = m_firstDirty; n < count; ++n) {
+			const NodeId parent = m_parent[n];
+			// A dirty parent has already been recomputed in this pass
+			if (parent != KNoParent && m_dirty[parent]) {
+				m_dirty[n] = 1;
+			}
+			if (!m_dirty[n]) {
+				continue;
+			}
+
+			const Transform& l = m_local[n];
+			WorldTransform& w = m_world[n];
+			if (parent == KNoParent) {
+				w.x = l.x;
+				w.y = l.y;
+				w.rotation = l.rotation;
+				w.sx = l.sx;
+				w.sy = l.sy;
+			}
+			else {
+				const WorldTransform& p = m_world[parent];
+				const float px = l.x * p.sx;
+				const float py = l.y * p.sy;
+				w.x = p.x + px * p.cos - py * p.sin;
+				w.y = p.y + px * p.sin + py * p.cos;
+				w.rotation = p.rotation + l.rotation;
+				w.sx = p.sx * l.sx;
+				w.sy = p.sy * l.sy;
+			}
+			w.sin = std::sin(w.rotation);
+			w.cos = std::cos(w.rotation);
+		}
+
+		if (m_firstDirty < count) {
+			std::fill(m_dirty.begin() + m_firstDirty, m_dirty.end(), (uint8_t)0);
+		}
+		m_firstDirty = KNoParent;
+	}
+
+	void SceneGraph::Draw(olc::RenderBatch& _batch, olc::Camera2D* _camera)
+	{
+		if (m_firstDirty != KNoParent) {
+			Update();
+		}
+
+		const NodeId count = (NodeId)m_parent.size();
+		for (NodeId n = 0; n < count; ++n) {
+			const SpriteData& sprite = m_sprites[n];
+			if (sprite.renderable == nullptr || !sprite.visible) {
+				continue;
+			}
+			const WorldTransform& w = m_world[n];
+			_batch.Draw(sprite.renderable, olc::vf2d(w.x, w.y), olc::vf2d(w.sx, w.sy),
+				w.rotation, sprite.origin, sprite.z, sprite.flip, sprite.tint, sprite.mode, _camera);
+		}
+	}
+
+	void SceneGraph::Clear()
+	{
+		m_parent.clear();
+		m_local.clear();
+		m_world.clear();
+		m_dirty.clear();
+		m_sprites.clear();
+		m_firstDirty = KNoParent;
+	}
+}
+#endif // OLC_PGEX_SCENEGRAPH
+#endif // __SCENEGRAPH_H_DEFINED__
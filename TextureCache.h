@@ -0,0 +1,285 @@
+/*
+	TextureCache.h
+	+-------------------------------------------------------------+
+	|         OneLoneCoder Pixel Game Engine Extension            |
+	|                TextureCache - v0.1.0                        |
+	+-------------------------------------------------------------+
+
+	What is this?
+	~~~~~~~~~~~~~
+	Owns the Renderables of image files by path and keeps their GPU
+	textures within a memory budget. A RenderBatch given the cache with
+	SetTextureCache() reports every Draw() of a cached Renderable, and
+	Update() evicts the textures which have been unused the longest until
+	the budget is met. Evicted textures are uploaded again the next time
+	they are drawn. Optionally the pixels are dropped as well and the 
+	file is loaded again on next use.
+
+	Textures drawn in the current frame are never evicted, their decals
+	are still queued in the engine.
+
+	Header only, used by RenderBatch.
+
+
+	License (OLC-3)
+	~~~~~~~~~~~~~~~
+
+	Copyright 2018 - 2021 OneLoneCoder.com
+
+	Redistribution and use in source and binary forms, with or without modification,
+	are permitted provided that the following conditions are met:
+
+	1. Redistributions or derivations of source code must retain the above copyright
+	notice, this list of conditions and the following disclaimer.
+
+	2. Redistributions or derivative works in binary form must reproduce the above
+	copyright notice. This list of conditions and the following	disclaimer must be
+	reproduced in the documentation and/or other materials provided with the distribution.
+
+	3. Neither the name of the copyright holder nor the names of its contributors may
+	be used to endorse or promote products derived from this software without specific
+	prior written permission.
+
+	THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS	"AS IS" AND ANY
+	EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+	OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+	SHALL THE COPYRIGHT	HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+	INCIDENTAL,	SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+	TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+	BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+	CONTRACT, STRICT LIABILITY, OR TORT	(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+	ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+	SUCH DAMAGE.
+
+	Links
+	~~~~~
+	Homepage:	https://github.com/codesmith-fi
+	Mail:		codesmith.fi@gmail.com
+
+	Author
+	~~~~~~
+	Erno Pakarinen (aka xanaki#9472 in discord, aka codesmith-fi)
+
+*/
+
+#ifndef __TEXTURECACHE_H_DEFINED__
+#define __TEXTURECACHE_H_DEFINED__
+
+#include <string>
+#include <memory>
+#include <vector>
+#include <unordered_map>
+#include <algorithm>
+#include <cstdint>
+
+namespace olc {
+
+class TextureCache
+{
+public: // Types
+	struct Metrics {
+		size_t budget = 0;
+		/// Bytes of resident GPU textures and of kept sprite pixels
+		size_t gpuBytes = 0;
+		size_t cpuBytes = 0;
+		size_t entries = 0;
+		size_t resident = 0;
+		/// Touch()es of resident textures, and of evicted or new ones
+		uint64_t hits = 0;
+		uint64_t misses = 0;
+		uint64_t evictions = 0;
+		inline float hitRate() const { return hits + misses > 0 ? (float)hits / (float)(hits + misses) : 1.0f; }
+	};
+
+public:
+	/// Keep at most _budgetBytes of GPU textures, images are loaded from
+	/// _pack when given
+	explicit TextureCache(size_t _budgetBytes, olc::ResourcePack* _pack = nullptr) :
+		m_pack(_pack) { m_metrics.budget = _budgetBytes; }
+
+	TextureCache(const TextureCache&) = delete;
+	TextureCache& operator=(const TextureCache&) = delete;
+
+	inline void SetBudget(size_t _bytes) { m_metrics.budget = _bytes; }
+
+	/// Also drop the sprite of evicted textures, the file is loaded again
+	/// on next use. Saves the CPU memory too, but reloading is slower.
+	inline void SetEvictSprites(bool _enable) { m_evictSprites = _enable; }
+
+	/// Free the pixels of images loaded from now on once they are uploaded,
+	/// see Renderable::SetKeepPixels(). Evicted textures are then loaded 
+	/// again from the file.
+	inline void SetKeepPixels(bool _keep) { m_keepPixels = _keep; }
+
+	/// Make mipmaps of images loaded from now on, see Renderable::SetMipmaps()
+	inline void SetMipmaps(bool _mipmaps) { m_mipmaps = _mipmaps; }
+
+	/// The Renderable of image file _file, loaded on first use. The 
+	/// pointer stays valid for the lifetime of the cache. Failed loads
+	/// give a Renderable without a Decal, which RenderBatch skips.
+	olc::Renderable* Get(const std::string& _file, bool _filter = false, bool _clamp = true)
+	{
+		auto found = m_byFile.find(_file);
+		if (found != m_byFile.end()) {
+			return &m_entries[found->second]->renderable;
+		}
+		std::unique_ptr<Entry> entry(new Entry());
+		entry->file = _file;
+		entry->filter = _filter;
+		entry->clamp = _clamp;
+		entry->renderable.SetKeepPixels(m_keepPixels);
+		entry->renderable.SetMipmaps(m_mipmaps);
+		olc::Renderable* renderable = &entry->renderable;
+		m_byFile.emplace(_file, m_entries.size());
+		m_byRenderable.emplace(renderable, m_entries.size());
+		m_entries.push_back(std::move(entry));
+		m_metrics.entries = m_entries.size();
+		Touch(renderable);
+		return renderable;
+	}
+
+	/// Record a use of _renderable in this frame and make its texture 
+	/// resident if it was evicted. Renderables not owned by the cache 
+	/// are ignored. RenderBatch calls this for every Draw().
+	void Touch(olc::Renderable* _renderable)
+	{
+		Entry* entry = m_last;
+		if (entry == nullptr || &entry->renderable != _renderable) {
+			auto found = m_byRenderable.find(_renderable);
+			if (found == m_byRenderable.end()) {
+				return;
+			}
+			entry = m_entries[found->second].get();
+			m_last = entry;
+		}
+		entry->frame = m_frame;
+		if (entry->failed) {
+			return;
+		}
+		if (entry->resident) {
+			++m_metrics.hits;
+			return;
+		}
+		++m_metrics.misses;
+		if (entry->renderable.Sprite() != nullptr) {
+			entry->renderable.RestoreDecal();
+			if (entry->renderable.Decal() == nullptr) {
+				entry->failed = true;
+				return;
+			}
+			// The mip levels are made again
+			updateCpuBytes(*entry);
+		}
+		else if (entry->renderable.Load(entry->file, m_pack, entry->filter, entry->clamp) == olc::rcode::OK) {
+			// Mip levels are textures of their own
+			entry->bytes = 0;
+			for (int32_t level = 0; level < entry->renderable.MipLevels(); ++level) {
+				const olc::Sprite* sprite = entry->renderable.Mip(level)->Sprite();
+				entry->bytes += (size_t)sprite->width * sprite->height * sizeof(olc::Pixel);
+			}
+			updateCpuBytes(*entry);
+		}
+		else {
+			entry->failed = true;
+			return;
+		}
+		entry->resident = true;
+		m_metrics.gpuBytes += entry->bytes;
+		++m_metrics.resident;
+	}
+
+	/// Evict the least recently used textures until the budget is met,
+	/// then start a new frame. Call once per frame, e.g. after End().
+	void Update()
+	{
+		if (m_metrics.gpuBytes > m_metrics.budget) {
+			m_candidates.clear();
+			for (auto& entry : m_entries) {
+				if (entry->resident && entry->frame != m_frame) {
+					m_candidates.push_back(entry.get());
+				}
+			}
+			std::sort(m_candidates.begin(), m_candidates.end(), [](const Entry* _a, const Entry* _b) {
+				return _a->frame < _b->frame;
+			});
+			for (Entry* entry : m_candidates) {
+				if (m_metrics.gpuBytes <= m_metrics.budget) {
+					break;
+				}
+				evict(*entry);
+			}
+		}
+		++m_frame;
+	}
+
+	/// Evict every texture which is not used in the current frame
+	void Trim()
+	{
+		for (auto& entry : m_entries) {
+			if (entry->resident && entry->frame != m_frame) {
+				evict(*entry);
+			}
+		}
+	}
+
+	inline const Metrics& GetMetrics() const { return m_metrics; }
+
+private:
+	struct Entry {
+		olc::Renderable renderable;
+		std::string file;
+		bool filter = false;
+		bool clamp = true;
+		bool resident = false;
+		bool failed = false;
+		size_t bytes = 0;
+		size_t cpuBytes = 0;
+		uint64_t frame = 0;
+	};
+
+	void evict(Entry& _entry)
+	{
+		// Frees the mip levels, pixels included
+		_entry.renderable.ReleaseDecal();
+		_entry.resident = false;
+		m_metrics.gpuBytes -= _entry.bytes;
+		--m_metrics.resident;
+		++m_metrics.evictions;
+		if (m_evictSprites) {
+			_entry.renderable = olc::Renderable();
+			_entry.renderable.SetKeepPixels(m_keepPixels);
+			_entry.renderable.SetMipmaps(m_mipmaps);
+		}
+		updateCpuBytes(_entry);
+	}
+
+	/** Count the pixels _entry keeps in memory again, after they changed */
+	void updateCpuBytes(Entry& _entry)
+	{
+		m_metrics.cpuBytes -= _entry.cpuBytes;
+		_entry.cpuBytes = 0;
+		for (int32_t level = 0; level < _entry.renderable.MipLevels(); ++level) {
+			_entry.cpuBytes += _entry.renderable.Mip(level)->Sprite()->pColData.size() * sizeof(olc::Pixel);
+		}
+		m_metrics.cpuBytes += _entry.cpuBytes;
+	}
+
+private:
+	olc::ResourcePack* m_pack = nullptr;
+	bool m_evictSprites = false;
+	bool m_keepPixels = true;
+	bool m_mipmaps = false;
+	// Entries are never removed, so indices and Renderable pointers stay valid
+	std::vector<std::unique_ptr<Entry>> m_entries;
+	std::unordered_map<std::string, size_t> m_byFile;
+	std::unordered_map<const olc::Renderable*, size_t> m_byRenderable;
+	// Consecutive Touch()es of the same Renderable are the common case
+	Entry* m_last = nullptr;
+	std::vector<Entry*> m_candidates;
+	uint64_t m_frame = 1;
+	Metrics m_metrics;
+};
+
+} // namespace olc
+
+#endif // __TEXTURECACHE_H_DEFINED__
@@ -0,0 +1,231 @@
+/*
+	ThreadPool.h
+	+-------------------------------------------------------------+
+	|         OneLoneCoder Pixel Game Engine Extension            |
+	|                ThreadPool - v0.2.0                          |
+	+-------------------------------------------------------------+
+
+	What is this?
+	~~~~~~~~~~~~~
+	A small persistent thread pool for splitting a frame's work over all 
+	cores. The threads are started once and sleep between jobs, so a 
+	ParallelFor() per frame costs a wake up and not a thread creation.
+	The calling thread takes part in the work.
+
+	Between ParallelFor() calls the threads also run background tasks
+	given with Submit(), like decoding images for AsyncLoader.
+
+	Header only, used by RenderBatch for tiled software rendering.
+
+
+	License (OLC-3)
+	~~~~~~~~~~~~~~~
+
+	Copyright 2018 - 2021 OneLoneCoder.com
+
+	Redistribution and use in source and binary forms, with or without modification,
+	are permitted provided that the following conditions are met:
+
+	1. Redistributions or derivations of source code must retain the above copyright
+	notice, this list of conditions and the following disclaimer.
+
+	2. Redistributions or derivative works in binary form must reproduce the above
+	copyright notice. This list of conditions and the following	disclaimer must be
+	reproduced in the documentation and/or other materials provided with the distribution.
+
+	3. Neither the name of the copyright holder nor the names of its contributors may
+	be used to endorse or promote products derived from this software without specific
+	prior written permission.
+
+	THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS	"AS IS" AND ANY
+	EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+	OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+	SHALL THE COPYRIGHT	HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+	INCIDENTAL,	SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+	TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+	BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+	CONTRACT, STRICT LIABILITY, OR TORT	(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+	ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+	SUCH DAMAGE.
+
+	Links
+	~~~~~
+	Homepage:	https://github.com/codesmith-fi
+	Mail:		codesmith.fi@gmail.com
+
+	Author
+	~~~~~~
+	Erno Pakarinen (aka xanaki#9472 in discord, aka codesmith-fi)
+
+*/
+
+#ifndef __THREADPOOL_H_DEFINED__
+#define __THREADPOOL_H_DEFINED__
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
+#include <deque>
+#include <algorithm>
+#include <cstdint>
+#include <assert.h>
+
+namespace olc {
+
+class ThreadPool
+{
+public: // Types
+	/// Job for ParallelFor(), called with the job index and the index of
+	/// the thread running it, 0 .. Size() - 1
+	typedef std::function<void(size_t _index, size_t _thread)> Job;
+
+	/// Background task for Submit()
+	typedef std::function<void()> Task;
+
+public:
+	/// Start a pool of _threads threads including the calling one, 
+	/// 0 uses all hardware threads
+	explicit ThreadPool(size_t _threads = 0)
+	{
+		if (_threads == 0) {
+			_threads = std::max(1u, std::thread::hardware_concurrency());
+		}
+		for (size_t n = 1; n < _threads; ++n) {
+			m_workers.emplace_back(&ThreadPool::workerLoop, this, n);
+		}
+	}
+
+	/// Queued tasks are finished before the threads stop
+	~ThreadPool()
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_quit = true;
+		}
+		m_wake.notify_all();
+		for (std::thread& worker : m_workers) {
+			worker.join();
+		}
+	}
+
+	ThreadPool(const ThreadPool&) = delete;
+	ThreadPool& operator=(const ThreadPool&) = delete;
+
+	/// Number of threads running jobs, including the calling thread
+	inline size_t Size() const { return m_workers.size() + 1; }
+
+	/// Run _task on one of the threads and return immediately. Tasks start
+	/// in the order they were submitted. A ParallelFor() takes precedence
+	/// over tasks which have not started yet, and does not wait for the 
+	/// running ones. Without other threads _task runs before this returns.
+	void Submit(Task _task)
+	{
+		if (m_workers.empty()) {
+			_task();
+			return;
+		}
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_tasks.push_back(std::move(_task));
+		}
+		m_wake.notify_one();
+	}
+
+	/// Run _job for every index in 0 .. _count - 1 and return when all of
+	/// them are done. Indices are handed out in increasing order to 
+	/// whichever thread is free. Must not be called from within a job.
+	void ParallelFor(size_t _count, const Job& _job)
+	{
+		if (_count == 0) {
+			return;
+		}
+		if (m_workers.empty() || _count == 1) {
+			for (size_t n = 0; n < _count; ++n) {
+				_job(n, 0);
+			}
+			return;
+		}
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			assert(m_job == nullptr);
+			m_job = &_job;
+			m_count = _count;
+			m_next = 0;
+			++m_generation;
+		}
+		m_wake.notify_all();
+		runJobs(0);
+
+		// All indices are handed out, wait for the workers still running 
+		// one. Workers which were busy with a task skip this job.
+		std::unique_lock<std::mutex> lock(m_mutex);
+		m_done.wait(lock, [this] { return m_busy == 0; });
+		m_job = nullptr;
+	}
+
+private:
+	void workerLoop(size_t _thread)
+	{
+		uint64_t seen = 0;
+		for (;;) {
+			Task task;
+			{
+				std::unique_lock<std::mutex> lock(m_mutex);
+				m_wake.wait(lock, [this, seen] { 
+					return m_quit || !m_tasks.empty() || (m_job != nullptr && m_generation != seen);
+				});
+				if (m_job != nullptr && m_generation != seen) {
+					seen = m_generation;
+					++m_busy;
+				}
+				else if (!m_tasks.empty()) {
+					task = std::move(m_tasks.front());
+					m_tasks.pop_front();
+				}
+				else {
+					return;
+				}
+			}
+			if (task) {
+				task();
+				continue;
+			}
+			runJobs(_thread);
+			{
+				std::lock_guard<std::mutex> lock(m_mutex);
+				if (--m_busy == 0) {
+					m_done.notify_one();
+				}
+			}
+		}
+	}
+
+	void runJobs(size_t _thread)
+	{
+		for (size_t n = m_next++; n < m_count; n = m_next++) {
+			(*m_job)(n, _thread);
+		}
+	}
+
+private:
+	std::vector<std::thread> m_workers;
+	std::mutex m_mutex;
+	std::condition_variable m_wake;
+	std::condition_variable m_done;
+	// Current ParallelFor(), written under m_mutex before m_generation changes
+	const Job* m_job = nullptr;
+	size_t m_count = 0;
+	std::atomic<size_t> m_next{ 0 };
+	// Workers running jobs of the current generation
+	size_t m_busy = 0;
+	uint64_t m_generation = 0;
+	std::deque<Task> m_tasks;
+	bool m_quit = false;
+};
+
+} // namespace olc
+
+#endif // __THREADPOOL_H_DEFINED__
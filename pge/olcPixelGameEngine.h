@@ -345,10 +345,24 @@ int main()
 #include <algorithm>
 #include <array>
 #include <cstring>
+#include <cstdio>
 #pragma endregion
 
 #define PGE_VER 215
 
+// SIMD kernels for software sprite drawing and resource pack scrambling, define OLC_PGE_NO_SIMD to use
+// plain C++ only. AVX2 is used when the compiler targets it (e.g. /arch:AVX2, -mavx2)
+#if !defined(OLC_PGE_NO_SIMD)
+	#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+		#define OLC_PGE_SSE2
+		#include <emmintrin.h>
+	#endif
+	#if defined(OLC_PGE_SSE2) && defined(__AVX2__)
+		#define OLC_PGE_AVX2
+		#include <immintrin.h>
+	#endif
+#endif
+
 // O------------------------------------------------------------------------------O
 // | COMPILER CONFIGURATION ODDITIES                                              |
 // O------------------------------------------------------------------------------O
@@ -479,6 +493,19 @@ int main()
 		#include <GLUT/glut.h>
 	#endif
 #endif
+
+// Resource packs are memory mapped where possible, define OLC_PGE_NO_MMAP to read them into memory
+#if !defined(OLC_PGE_NO_MMAP)
+	#if defined(OLC_PLATFORM_WINAPI)
+		#define OLC_RESOURCEPACK_MMAP
+	#elif defined(__unix__) || defined(__APPLE__)
+		#define OLC_RESOURCEPACK_MMAP
+		#include <sys/mman.h>
+		#include <sys/stat.h>
+		#include <fcntl.h>
+		#include <unistd.h>
+	#endif
+#endif
 #pragma endregion
 
 // O------------------------------------------------------------------------------O
@@ -655,9 +682,22 @@ namespace olc
 	// O------------------------------------------------------------------------------O
 	// | olc::ResourcePack - A virtual scrambled filesystem to pack your assets into  |
 	// O------------------------------------------------------------------------------O
+	// Read only view of a file inside a loaded ResourcePack, no data is copied
+	struct ResourceView
+	{
+		const char* pData = nullptr;
+		size_t nSize = 0;
+		const char* data() const { return pData; }
+		size_t size() const { return nSize; }
+		bool empty() const { return nSize == 0; }
+		const char* begin() const { return pData; }
+		const char* end() const { return pData + nSize; }
+	};
+
 	struct ResourceBuffer : public std::streambuf
 	{
 		ResourceBuffer(std::ifstream& ifs, uint32_t offset, uint32_t size);
+		ResourceBuffer(const ResourceView& view);
 		std::vector<char> vMemory;
 	};
 
@@ -666,15 +706,45 @@ namespace olc
 	public:
 		ResourcePack();
 		~ResourcePack();
+		ResourcePack(const ResourcePack&) = delete;
+		ResourcePack& operator=(const ResourcePack&) = delete;
 		bool AddFile(const std::string& sFile);
 		bool LoadPack(const std::string& sFile, const std::string& sKey);
 		bool SavePack(const std::string& sFile, const std::string& sKey);
+		// Copy of a file in the pack
 		ResourceBuffer GetFileBuffer(const std::string& sFile);
+		// View of a file in the pack, valid until the pack is destroyed or reloaded.
+		// Empty if the file is not in the pack
+		ResourceView GetFileView(const std::string& sFile);
 		bool Loaded();
+
+		// XORs a stream with a repeating key chunk by chunk, the result is the 
+		// same as scrambling it in one piece. src and dst may be the same
+		class Scrambler
+		{
+		public:
+			Scrambler(const std::string& sKey);
+			void Process(const char* src, char* dst, size_t size);
+		private:
+			// The key repeated, so that nStride bytes can be read from any key offset
+			std::vector<char> vPattern;
+			size_t nKeySize = 0;
+			size_t nStride = 0;
+			size_t nKeyOffset = 0;
+		};
 	private:
 		struct sResourceFile { uint32_t nSize; uint32_t nOffset; };
 		std::map<std::string, sResourceFile> mapFiles;
-		std::ifstream baseFile;
+		// The whole pack file, memory mapped, or read into vPackData if it can't be
+		const char* pPackData = nullptr;
+		size_t nPackSize = 0;
+		std::vector<char> vPackData;
+#if defined(OLC_RESOURCEPACK_MMAP) && defined(OLC_PLATFORM_WINAPI)
+		HANDLE hPackFile = INVALID_HANDLE_VALUE;
+		HANDLE hPackMapping = nullptr;
+#endif
+		bool OpenPack(const std::string& sFile);
+		void ClosePack();
 		std::vector<char> scramble(const std::vector<char>& data, const std::string& key);
 		std::string makeposix(const std::string& path);
 	};
@@ -721,13 +791,43 @@ namespace olc
 		bool  SetPixel(const olc::vi2d& a, Pixel p);
 		Pixel Sample(float x, float y) const;
 		Pixel SampleBL(float u, float v) const;
+		// Bilinear samples of count normalised coordinates into out, alpha is 
+		// interpolated too. Edges clamp in NORMAL mode and wrap in PERIODIC mode
+		void SampleBL(const olc::vf2d* uv, Pixel* out, size_t count) const;
 		Pixel* GetData();
 		olc::Sprite* Duplicate();
 		olc::Sprite* Duplicate(const olc::vi2d& vPos, const olc::vi2d& vSize);
+		// Half size copy for mipmaps, each pixel is the rounded average of a 2x2 
+		// block. Odd rows and columns at the end are dropped, like OpenGL does
+		olc::Sprite* Mipmap() const;
 		std::vector<olc::Pixel> pColData;
 		Mode modeSample = Mode::NORMAL;
 
 		static std::unique_ptr<olc::ImageLoader> loader;
+
+		// Caches decoded images as raw pixels in sDirectory, so that LoadFromFile()
+		// reads them back instead of decoding again. Entries are keyed by the
+		// image path and checked against its modification time and size, or the
+		// packed contents for images in a ResourcePack. Empty disables the cache.
+		// Set it before loading anything, it is not synchronised with AsyncLoader
+		static void SetRawCache(const std::string& sDirectory);
+
+	private:
+		// Cache file: this header padded to nRawAlign bytes, then the pixels
+		struct sRawHeader
+		{
+			char magic[8];
+			uint32_t nVersion;
+			uint32_t nFlags; // Compression, none so far
+			int32_t nWidth;
+			int32_t nHeight;
+			uint64_t nKey;
+			uint64_t nStamp;
+		};
+		static constexpr size_t nRawAlign = 4096;
+		static std::string sRawCache;
+		olc::rcode LoadFromRawFile(const std::string& sRawFile, uint64_t nKey, uint64_t nStamp);
+		olc::rcode SaveToRawFile(const std::string& sRawFile, uint64_t nKey, uint64_t nStamp) const;
 	};
 
 	// O------------------------------------------------------------------------------O
@@ -767,12 +867,50 @@ namespace olc
 		Renderable() = default;
 		olc::rcode Load(const std::string& sFile, ResourcePack* pack = nullptr, bool filter = false, bool clamp = true);
 		void Create(uint32_t width, uint32_t height, bool filter = false, bool clamp = true);
+		// Takes an already loaded sprite, e.g. one decoded on another thread. 
+		// Creates the decal, so must be called on the engine thread
+		void Create(std::unique_ptr<olc::Sprite> sprite, bool filter = false, bool clamp = true);
 		olc::Decal* Decal() const;
 		olc::Sprite* Sprite() const;
+		// Destroys the GPU texture but keeps the sprite, RestoreDecal() uploads 
+		// it again with the same filter and clamp settings
+		void ReleaseDecal();
+		void RestoreDecal();
+		// With keep = false, Load() and Create() free the sprite's pixels once
+		// they are uploaded and keep only its width and height. For renderables
+		// which are only drawn as decals, it halves the memory they use
+		void SetKeepPixels(bool keep);
+		// Frees the pixels of the sprite, the texture stays as it is
+		void ReleasePixels();
+		// Brings the pixels back, read from the texture, or loaded again from
+		// the file if the texture has been released
+		olc::rcode RestorePixels();
+		// With mipmaps = true, Load() and Create() also make smaller copies of
+		// the image, each half the size of the previous one, down to 1 pixel.
+		// RenderBatch draws the one closest to the size on the screen
+		void SetMipmaps(bool mipmaps);
+		// Level 0 is this renderable, higher levels are the smaller copies
+		int32_t MipLevels() const;
+		olc::Renderable* Mip(int32_t level);
+		// Unique id of the image, a new one every time Load() or Create() 
+		// changes it, 0 without an image. Lets caches of image properties
+		// tell when a renderable has been given another image
+		uint64_t ImageId() const;
 
 	private:
+		void MakeMips();
+		static uint64_t NextImageId();
 		std::unique_ptr<olc::Sprite> pSprite = nullptr;
 		std::unique_ptr<olc::Decal> pDecal = nullptr;
+		bool bFilter = false;
+		bool bClamp = true;
+		bool bKeepPixels = true;
+		bool bMipmaps = false;
+		std::vector<std::unique_ptr<olc::Renderable>> vMips;
+		uint64_t nImageId = 0;
+		// Where Load() got the image from, to restore dropped pixels
+		std::string sSourceFile;
+		ResourcePack* pSourcePack = nullptr;
 	};
 
 
@@ -802,6 +940,15 @@ namespace olc
 		std::vector<DecalInstance> vecDecalInstance;
 		olc::Pixel tint = olc::WHITE;
 		std::function<void()> funcHook = nullptr;
+		// Dirty tiles of nDirtyTileSize pixels, one byte each, see EnableLayerDirtyTracking()
+		static constexpr int32_t nDirtyTileShift = 5;
+		static constexpr int32_t nDirtyTileSize = 1 << nDirtyTileShift;
+		bool bDirtyTracking = false;
+		int32_t nDirtyTilesX = 0;
+		std::vector<uint8_t> vDirtyTiles;
+		// Decal only layers are skipped in frames without pixel writes, see SetLayerDecalOnly()
+		bool bDecalOnly = false;
+		bool bWritten = false;
 	};
 
 	class Renderer
@@ -818,6 +965,12 @@ namespace olc
 		virtual void       DrawDecal(const olc::DecalInstance& decal) = 0;
 		virtual uint32_t   CreateTexture(const uint32_t width, const uint32_t height, const bool filtered = false, const bool clamp = true) = 0;
 		virtual void       UpdateTexture(uint32_t id, olc::Sprite* spr) = 0;
+		// Uploads only the given area of the sprite and returns the bytes uploaded,
+		// renderers without sub image uploads fall back to uploading all of it
+		virtual uint64_t   UpdateTextureRegion(uint32_t id, olc::Sprite* spr, const olc::vi2d& pos, const olc::vi2d& size) { UNUSED(pos); UNUSED(size); UpdateTexture(id, spr); return uint64_t(spr->width) * spr->height * sizeof(Pixel); }
+		// False if UpdateTextureRegion() uploads whole rows, the areas of a frame
+		// are then merged into one row span
+		virtual bool       UpdatesPartialRows() const { return false; }
 		virtual void       ReadTexture(uint32_t id, olc::Sprite* spr) = 0;
 		virtual uint32_t   DeleteTexture(const uint32_t id) = 0;
 		virtual void       ApplyTexture(uint32_t id) = 0;
@@ -928,6 +1081,18 @@ namespace olc
 
 		std::vector<LayerDesc>& GetLayers();
 		uint32_t CreateLayer();
+		// Tracks which areas of a layer are drawn to, so that only those are 
+		// uploaded to the GPU instead of the whole layer every time it changes.
+		// Writes which bypass the drawing routines, e.g. directly to pColData,
+		// must be reported with MarkLayerDirty()
+		void EnableLayerDirtyTracking(uint8_t layer, bool b);
+		void MarkLayerDirty(uint8_t layer, const olc::vi2d& pos, const olc::vi2d& size);
+		// Bytes of layer pixel data uploaded to the GPU in the last frame
+		uint64_t GetLayerUploadBytes() const;
+		// A decal only layer is neither uploaded nor drawn in frames in which
+		// nothing was drawn into its pixels, only its decals are displayed.
+		// Like dirty tracking, direct writes must be reported with MarkLayerDirty()
+		void SetLayerDecalOnly(uint8_t layer, bool b);
 
 		// Change the pixel mode for different optimisations
 		// olc::Pixel::NORMAL = No transparency
@@ -974,6 +1139,10 @@ namespace olc
 		// selected area is (ox,oy) to (ox+w,oy+h)
 		void DrawPartialSprite(int32_t x, int32_t y, Sprite* sprite, int32_t ox, int32_t oy, int32_t w, int32_t h, uint32_t scale = 1, uint8_t flip = olc::Sprite::NONE);
 		void DrawPartialSprite(const olc::vi2d& pos, Sprite* sprite, const olc::vi2d& sourcepos, const olc::vi2d& size, uint32_t scale = 1, uint8_t flip = olc::Sprite::NONE);
+		// Draws an entire sprite, or an area of it, at location pos scaled 
+		// by any factor per axis, nearest neighbour
+		void DrawScaledSprite(const olc::vf2d& pos, Sprite* sprite, const olc::vf2d& scale, uint8_t flip = olc::Sprite::NONE);
+		void DrawPartialScaledSprite(const olc::vf2d& pos, Sprite* sprite, const olc::vi2d& sourcepos, const olc::vi2d& size, const olc::vf2d& scale, uint8_t flip = olc::Sprite::NONE);
 		// Draws a single line of text - traditional monospaced
 		void DrawString(int32_t x, int32_t y, const std::string& sText, Pixel col = olc::WHITE, uint32_t scale = 1);
 		void DrawString(const olc::vi2d& pos, const std::string& sText, Pixel col = olc::WHITE, uint32_t scale = 1);
@@ -1052,6 +1221,8 @@ namespace olc
 		Sprite*     pDefaultDrawTarget = nullptr;
 		std::vector<LayerDesc> vLayers;
 		uint8_t		nTargetLayer = 0;
+		int32_t		nDirtyLayer = -1;
+		uint64_t	nLayerUploadBytes = 0;
 		uint32_t	nLastFPS = 0;
 		bool        bPixelCohesion = false;
 		DecalMode   nDecalMode = DecalMode::NORMAL;
@@ -1072,6 +1243,23 @@ namespace olc
 		// The main engine thread
 		void		EngineThread();
 
+		// Fast path of DrawSprite() and DrawPartialSprite(), clips once and
+		// draws whole rows. Returns false if the per pixel path is needed
+		bool olc_BlitSprite(int32_t x, int32_t y, const Sprite* sprite, int32_t ox, int32_t oy, int32_t w, int32_t h, uint8_t flip);
+		// Draws count pixels of src into dst with the given pixel mode, blend is 
+		// fBlendFactor in 0 - 257 fixed point
+		static void olc_BlitRow(Pixel* dst, const Pixel* src, int32_t count, Pixel::Mode mode, uint32_t blend);
+		// Scaled DrawSprite() and DrawPartialSprite(), draws whole rows unless
+		// a per pixel path is needed
+		void olc_BlitScaledSprite(const olc::vf2d& pos, const Sprite* sprite, int32_t ox, int32_t oy, int32_t w, int32_t h, const olc::vf2d& scale, uint8_t flip);
+		std::vector<Pixel> vBlitRow;
+		std::vector<int32_t> vBlitColumns;
+
+		// Dirty tile tracking, nDirtyLayer is the tracked or decal only layer being drawn to or -1
+		void olc_UpdateDirtyLayer();
+		void olc_MarkDirty(LayerDesc& layer, int32_t x0, int32_t y0, int32_t x1, int32_t y1);
+		uint64_t olc_UploadDirtyTiles(LayerDesc& layer);
+
 
 		// If anything sets this flag to false, the engine
 		// "should" shut down gracefully
@@ -1330,6 +1518,8 @@ namespace olc
 
 	Pixel Sprite::GetPixel(int32_t x, int32_t y) const
 	{
+		if (pColData.empty())
+			return Pixel(0, 0, 0, 0);
 		if (modeSample == olc::Sprite::Mode::NORMAL)
 		{
 			if (x >= 0 && x < width && y >= 0 && y < height)
@@ -1345,7 +1535,7 @@ namespace olc
 
 	bool Sprite::SetPixel(int32_t x, int32_t y, Pixel p)
 	{
-		if (x >= 0 && x < width && y >= 0 && y < height)
+		if (x >= 0 && x < width && y >= 0 && y < height && !pColData.empty())
 		{
 			pColData[y * width + x] = p;
 			return true;
@@ -1383,20 +1573,206 @@ namespace olc
 			(uint8_t)((p1.b * u_opposite + p2.b * u_ratio) * v_opposite + (p3.b * u_opposite + p4.b * u_ratio) * v_ratio));
 	}
 
+	void Sprite::SampleBL(const olc::vf2d* uv, Pixel* out, size_t count) const
+	{
+		if (width <= 0 || height <= 0 || pColData.empty())
+			return;
+
+		// Texel coordinates in 24.8 fixed point, relative to texel centres
+		const bool bWrap = modeSample == olc::Sprite::Mode::PERIODIC;
+		const uint32_t* pTexels = reinterpret_cast<const uint32_t*>(pColData.data());
+		int32_t nCoord[4];
+
+		// Fetches the 4 texels around 24.8 coordinate (fx, fy), clamped or wrapped
+		auto fetch = [&](int32_t fx, int32_t fy, uint32_t* p)
+		{
+			int32_t x0 = fx >> 8, y0 = fy >> 8, x1, y1;
+			if (bWrap)
+			{
+				x0 %= width; if (x0 < 0) x0 += width;
+				y0 %= height; if (y0 < 0) y0 += height;
+				x1 = x0 + 1 == width ? 0 : x0 + 1;
+				y1 = y0 + 1 == height ? 0 : y0 + 1;
+			}
+			else
+			{
+				x1 = std::min(std::max(x0 + 1, 0), width - 1);
+				y1 = std::min(std::max(y0 + 1, 0), height - 1);
+				x0 = std::min(std::max(x0, 0), width - 1);
+				y0 = std::min(std::max(y0, 0), height - 1);
+			}
+			p[0] = pTexels[y0 * width + x0]; p[1] = pTexels[y0 * width + x1];
+			p[2] = pTexels[y1 * width + x0]; p[3] = pTexels[y1 * width + x1];
+		};
+
+		size_t i = 0;
+#if defined(OLC_PGE_SSE2)
+		const __m128 mScale = _mm_setr_ps(width * 256.0f, height * 256.0f, width * 256.0f, height * 256.0f);
+		const __m128 mHalf = _mm_set1_ps(128.0f);
+		const __m128i zero = _mm_setzero_si128();
+		const __m128i mFull = _mm_set1_epi16(256);
+		// floor() of 4 floats, converted to int
+		auto floorInt = [](__m128 v)
+		{
+			__m128i t = _mm_cvttps_epi32(v);
+			return _mm_add_epi32(t, _mm_castps_si128(_mm_cmpgt_ps(_mm_cvtepi32_ps(t), v)));
+		};
+		for (; i + 2 <= count; i += 2)
+		{
+			// Coordinates of two samples at a time, u0 v0 u1 v1
+			const __m128 mUV = _mm_loadu_ps(&uv[i].x);
+			const __m128i mFixed = floorInt(_mm_sub_ps(_mm_mul_ps(mUV, mScale), mHalf));
+			_mm_storeu_si128((__m128i*)nCoord, mFixed);
+
+			for (size_t n = 0; n < 2; n++)
+			{
+				uint32_t p[4];
+				fetch(nCoord[n * 2], nCoord[n * 2 + 1], p);
+				const __m128i mTexels = _mm_loadu_si128((const __m128i*)p);
+
+				// Weights of this sample as 16 bit lanes, 256 - w for the first texel of each pair
+				const int32_t wx = nCoord[n * 2] & 0xFF;
+				const int32_t wy = nCoord[n * 2 + 1] & 0xFF;
+				const __m128i mWx = _mm_unpacklo_epi64(_mm_sub_epi16(mFull, _mm_set1_epi16((short)wx)), _mm_set1_epi16((short)wx));
+				const __m128i mWy = _mm_unpacklo_epi64(_mm_sub_epi16(mFull, _mm_set1_epi16((short)wy)), _mm_set1_epi16((short)wy));
+
+				// Horizontal lerp of the top and the bottom pair, then vertical
+				__m128i top = _mm_mullo_epi16(_mm_unpacklo_epi8(mTexels, zero), mWx);
+				__m128i bottom = _mm_mullo_epi16(_mm_unpackhi_epi8(mTexels, zero), mWx);
+				top = _mm_srli_epi16(_mm_add_epi16(top, _mm_srli_si128(top, 8)), 8);
+				bottom = _mm_srli_epi16(_mm_add_epi16(bottom, _mm_srli_si128(bottom, 8)), 8);
+				__m128i v = _mm_mullo_epi16(_mm_unpacklo_epi64(top, bottom), mWy);
+				v = _mm_srli_epi16(_mm_add_epi16(v, _mm_srli_si128(v, 8)), 8);
+				out[i + n].n = (uint32_t)_mm_cvtsi128_si32(_mm_packus_epi16(v, zero));
+			}
+		}
+#endif
+		// Two channels at a time in 0x00FF00FF lanes, same result as above
+		auto lerp = [](uint32_t a, uint32_t b, uint32_t w)
+		{
+			const uint32_t rb = (((a & 0x00FF00FF) * (256 - w) + (b & 0x00FF00FF) * w) >> 8) & 0x00FF00FF;
+			const uint32_t ag = ((((a >> 8) & 0x00FF00FF) * (256 - w) + ((b >> 8) & 0x00FF00FF) * w) >> 8) & 0x00FF00FF;
+			return rb | (ag << 8);
+		};
+		for (; i < count; i++)
+		{
+			const int32_t fx = (int32_t)std::floor(uv[i].x * (width * 256.0f) - 128.0f);
+			const int32_t fy = (int32_t)std::floor(uv[i].y * (height * 256.0f) - 128.0f);
+			uint32_t p[4];
+			fetch(fx, fy, p);
+			out[i].n = lerp(lerp(p[0], p[1], fx & 0xFF), lerp(p[2], p[3], fx & 0xFF), fy & 0xFF);
+		}
+	}
+
 	Pixel* Sprite::GetData()
 	{ return pColData.data(); }
 
 
 	olc::rcode Sprite::LoadFromFile(const std::string& sImageFile, olc::ResourcePack* pack)
 	{
-		UNUSED(pack);
-		return loader->LoadImageResource(this, sImageFile, pack);
+		if (sRawCache.empty())
+			return loader->LoadImageResource(this, sImageFile, pack);
+
+		// FNV-1a, only used to recognise cache entries
+		auto hash = [](const char* data, size_t size, uint64_t h)
+		{
+			for (size_t i = 0; i < size; i++) h = (h ^ uint8_t(data[i])) * 0x100000001B3ull;
+			return h;
+		};
+		// The source is part of the key, a pack entry and a file on disk with
+		// the same name are different images
+		const char* sSource = pack != nullptr ? "pack:" : "disk:";
+		const uint64_t nKey = hash(sImageFile.data(), sImageFile.size(), hash(sSource, 5, 0xCBF29CE484222325ull));
+		uint64_t nStamp = 0;
+		if (pack != nullptr)
+		{
+			ResourceView view = pack->GetFileView(sImageFile);
+			if (view.empty()) return loader->LoadImageResource(this, sImageFile, pack);
+			nStamp = hash(view.data(), view.size(), 0xCBF29CE484222325ull);
+		}
+		else
+		{
+			std::error_code ec;
+			const auto tWrite = _gfs::last_write_time(sImageFile, ec);
+			const uint64_t nSize = uint64_t(_gfs::file_size(sImageFile, ec));
+			if (ec) return loader->LoadImageResource(this, sImageFile, pack);
+			nStamp = uint64_t(tWrite.time_since_epoch().count()) * 0x100000001B3ull ^ nSize;
+		}
+
+		char sName[24];
+		snprintf(sName, sizeof(sName), "%016llx", (unsigned long long)nKey);
+		const std::string sRawFile = sRawCache + "/" + sName + ".olcraw";
+		if (LoadFromRawFile(sRawFile, nKey, nStamp) == olc::rcode::OK)
+			return olc::rcode::OK;
+
+		olc::rcode result = loader->LoadImageResource(this, sImageFile, pack);
+		if (result == olc::rcode::OK)
+			SaveToRawFile(sRawFile, nKey, nStamp);
+		return result;
+	}
+
+	void Sprite::SetRawCache(const std::string& sDirectory)
+	{
+		sRawCache = sDirectory;
+		std::error_code ec;
+		if (!sRawCache.empty()) _gfs::create_directories(sRawCache, ec);
+	}
+
+	olc::rcode Sprite::LoadFromRawFile(const std::string& sRawFile, uint64_t nKey, uint64_t nStamp)
+	{
+		std::ifstream ifs(sRawFile, std::ifstream::binary);
+		if (!ifs.is_open()) return olc::rcode::NO_FILE;
+
+		sRawHeader header;
+		ifs.read((char*)&header, sizeof(sRawHeader));
+		if (!ifs || memcmp(header.magic, "OLCRAW\0\0", 8) != 0 || header.nVersion != 1 || header.nFlags != 0 ||
+			header.nKey != nKey || header.nStamp != nStamp || header.nWidth <= 0 || header.nHeight <= 0)
+			return olc::rcode::FAIL;
+
+		// Straight into the sprite's storage, no decoding
+		std::vector<olc::Pixel> vData(size_t(header.nWidth) * header.nHeight);
+		ifs.seekg(nRawAlign);
+		ifs.read((char*)vData.data(), vData.size() * sizeof(olc::Pixel));
+		if (!ifs) return olc::rcode::FAIL;
+		width = header.nWidth;
+		height = header.nHeight;
+		pColData.swap(vData);
+		return olc::rcode::OK;
+	}
+
+	olc::rcode Sprite::SaveToRawFile(const std::string& sRawFile, uint64_t nKey, uint64_t nStamp) const
+	{
+		sRawHeader header;
+		memcpy(header.magic, "OLCRAW\0\0", 8);
+		header.nVersion = 1;
+		header.nFlags = 0;
+		header.nWidth = width;
+		header.nHeight = height;
+		header.nKey = nKey;
+		header.nStamp = nStamp;
+		std::vector<char> vHeader(nRawAlign, 0);
+		memcpy(vHeader.data(), &header, sizeof(sRawHeader));
+
+		// Written under a temporary name, a reader never sees half a file
+		const std::string sTemp = sRawFile + "." + std::to_string(std::hash<std::thread::id>()(std::this_thread::get_id()));
+		{
+			std::ofstream ofs(sTemp, std::ofstream::binary);
+			if (!ofs.is_open()) return olc::rcode::FAIL;
+			ofs.write(vHeader.data(), vHeader.size());
+			ofs.write((const char*)pColData.data(), pColData.size() * sizeof(olc::Pixel));
+			if (!ofs) { ofs.close(); std::remove(sTemp.c_str()); return olc::rcode::FAIL; }
+		}
+		std::error_code ec;
+		_gfs::rename(sTemp, sRawFile, ec);
+		if (ec) { std::remove(sTemp.c_str()); return olc::rcode::FAIL; }
+		return olc::rcode::OK;
 	}
 
 	olc::Sprite* Sprite::Duplicate()
 	{
 		olc::Sprite* spr = new olc::Sprite(width, height);
-		std::memcpy(spr->GetData(), GetData(), width * height * sizeof(olc::Pixel));
+		if (!pColData.empty())
+			std::memcpy(spr->GetData(), GetData(), width * height * sizeof(olc::Pixel));
 		spr->modeSample = modeSample;
 		return spr;
 	}
@@ -1410,6 +1786,63 @@ namespace olc
 		return spr;
 	}
 
+	olc::Sprite* Sprite::Mipmap() const
+	{
+		olc::Sprite* spr = new olc::Sprite(std::max(width / 2, 1), std::max(height / 2, 1));
+		spr->modeSample = modeSample;
+		if (pColData.empty())
+			return spr;
+
+		for (int32_t y = 0; y < spr->height; y++)
+		{
+			// A 1 pixel high or wide sprite averages with itself
+			const uint32_t* pRow0 = reinterpret_cast<const uint32_t*>(pColData.data()) + size_t(y * 2) * width;
+			const uint32_t* pRow1 = height > 1 ? pRow0 + width : pRow0;
+			uint32_t* pOut = reinterpret_cast<uint32_t*>(spr->pColData.data()) + size_t(y) * spr->width;
+			int32_t x = 0;
+#if defined(OLC_PGE_SSE2)
+			if (width > 1)
+			{
+				// 4 destination pixels from 8 source pixels of both rows per iteration
+				const __m128i zero = _mm_setzero_si128();
+				const __m128i mRound = _mm_set1_epi16(2);
+				for (; x + 4 <= spr->width; x += 4)
+				{
+					const __m128i a0 = _mm_loadu_si128((const __m128i*)(pRow0 + x * 2));
+					const __m128i a1 = _mm_loadu_si128((const __m128i*)(pRow1 + x * 2));
+					const __m128i b0 = _mm_loadu_si128((const __m128i*)(pRow0 + x * 2 + 4));
+					const __m128i b1 = _mm_loadu_si128((const __m128i*)(pRow1 + x * 2 + 4));
+					// Vertical sums as 16 bit channels, two source pixels per register
+					const __m128i aLo = _mm_add_epi16(_mm_unpacklo_epi8(a0, zero), _mm_unpacklo_epi8(a1, zero));
+					const __m128i aHi = _mm_add_epi16(_mm_unpackhi_epi8(a0, zero), _mm_unpackhi_epi8(a1, zero));
+					const __m128i bLo = _mm_add_epi16(_mm_unpacklo_epi8(b0, zero), _mm_unpacklo_epi8(b1, zero));
+					const __m128i bHi = _mm_add_epi16(_mm_unpackhi_epi8(b0, zero), _mm_unpackhi_epi8(b1, zero));
+					// Horizontal sums of each pair, then (sum + 2) / 4
+					__m128i a = _mm_add_epi16(_mm_unpacklo_epi64(aLo, aHi), _mm_unpackhi_epi64(aLo, aHi));
+					__m128i b = _mm_add_epi16(_mm_unpacklo_epi64(bLo, bHi), _mm_unpackhi_epi64(bLo, bHi));
+					a = _mm_srli_epi16(_mm_add_epi16(a, mRound), 2);
+					b = _mm_srli_epi16(_mm_add_epi16(b, mRound), 2);
+					_mm_storeu_si128((__m128i*)(pOut + x), _mm_packus_epi16(a, b));
+				}
+			}
+#endif
+			// Two channels at a time in 0x00FF00FF lanes, same result as above
+			for (; x < spr->width; x++)
+			{
+				const int32_t x0 = x * 2, x1 = std::min(x * 2 + 1, width - 1);
+				const uint32_t p[4] = { pRow0[x0], pRow0[x1], pRow1[x0], pRow1[x1] };
+				uint32_t rb = 0x00020002, ag = 0x00020002;
+				for (uint32_t n : p)
+				{
+					rb += n & 0x00FF00FF;
+					ag += (n >> 8) & 0x00FF00FF;
+				}
+				pOut[x] = ((rb >> 2) & 0x00FF00FF) | (((ag >> 2) & 0x00FF00FF) << 8);
+			}
+		}
+		return spr;
+	}
+
 	// O------------------------------------------------------------------------------O
 	// | olc::Decal IMPLEMENTATION                                                    |
 	// O------------------------------------------------------------------------------O
@@ -1432,6 +1865,8 @@ namespace olc
 	{
 		if (sprite == nullptr) return;
 		vUVScale = { 1.0f / float(sprite->width), 1.0f / float(sprite->height) };
+		// Pixels dropped after upload, the texture is the only copy
+		if (sprite->pColData.empty()) return;
 		renderer->ApplyTexture(id);
 		renderer->UpdateTexture(id, sprite);
 	}
@@ -1439,6 +1874,7 @@ namespace olc
 	void Decal::UpdateSprite()
 	{
 		if (sprite == nullptr) return;
+		sprite->pColData.resize(size_t(sprite->width) * size_t(sprite->height));
 		renderer->ApplyTexture(id);
 		renderer->ReadTexture(id, sprite);
 	}
@@ -1454,22 +1890,124 @@ namespace olc
 
 	void Renderable::Create(uint32_t width, uint32_t height, bool filter, bool clamp)
 	{
+		bFilter = filter; bClamp = clamp;
+		sSourceFile.clear(); pSourcePack = nullptr;
+		nImageId = NextImageId();
 		pSprite = std::make_unique<olc::Sprite>(width, height);
 		pDecal = std::make_unique<olc::Decal>(pSprite.get(), filter, clamp);
+		MakeMips();
+		if (!bKeepPixels) ReleasePixels();
+	}
+
+	void Renderable::Create(std::unique_ptr<olc::Sprite> sprite, bool filter, bool clamp)
+	{
+		bFilter = filter; bClamp = clamp;
+		sSourceFile.clear(); pSourcePack = nullptr;
+		nImageId = NextImageId();
+		pSprite = std::move(sprite);
+		pDecal = std::make_unique<olc::Decal>(pSprite.get(), filter, clamp);
+		MakeMips();
+		if (!bKeepPixels) ReleasePixels();
+	}
+
+	void Renderable::ReleaseDecal()
+	{
+		// Without a file to load from, the texture holds the only copy of the pixels
+		if (pDecal != nullptr && pSprite != nullptr && pSprite->pColData.empty() && sSourceFile.empty())
+			pDecal->UpdateSprite();
+		pDecal.reset();
+		// Made again from the pixels by RestoreDecal()
+		vMips.clear();
+	}
+
+	void Renderable::RestoreDecal()
+	{
+		if (pSprite != nullptr && pDecal == nullptr)
+		{
+			if (RestorePixels() != olc::rcode::OK) return;
+			pDecal = std::make_unique<olc::Decal>(pSprite.get(), bFilter, bClamp);
+			MakeMips();
+			if (!bKeepPixels) ReleasePixels();
+		}
+	}
+
+	void Renderable::SetKeepPixels(bool keep)
+	{ bKeepPixels = keep; }
+
+	void Renderable::ReleasePixels()
+	{
+		// swap() so the memory is really freed, clear() would keep the capacity
+		if (pSprite != nullptr)
+			std::vector<olc::Pixel>().swap(pSprite->pColData);
+		for (auto& mip : vMips)
+			mip->ReleasePixels();
+	}
+
+	void Renderable::SetMipmaps(bool mipmaps)
+	{ bMipmaps = mipmaps; }
+
+	int32_t Renderable::MipLevels() const
+	{ return pSprite != nullptr ? int32_t(vMips.size()) + 1 : 0; }
+
+	olc::Renderable* Renderable::Mip(int32_t level)
+	{ return level <= 0 ? this : vMips[std::min(size_t(level), vMips.size()) - 1].get(); }
+
+	void Renderable::MakeMips()
+	{
+		vMips.clear();
+		if (!bMipmaps || pSprite == nullptr || pSprite->pColData.empty())
+			return;
+		// Each level from the previous one, pixels are dropped only at the end
+		const olc::Sprite* src = pSprite.get();
+		while (src->width > 1 || src->height > 1)
+		{
+			vMips.push_back(std::make_unique<olc::Renderable>());
+			vMips.back()->Create(std::unique_ptr<olc::Sprite>(src->Mipmap()), bFilter, bClamp);
+			src = vMips.back()->Sprite();
+		}
+	}
+
+	olc::rcode Renderable::RestorePixels()
+	{
+		if (pSprite == nullptr) return olc::rcode::FAIL;
+		if (!pSprite->pColData.empty() || pSprite->width <= 0 || pSprite->height <= 0) return olc::rcode::OK;
+
+		if (pDecal != nullptr)
+		{
+			pDecal->UpdateSprite();
+			for (auto& mip : vMips)
+				mip->RestorePixels();
+			return olc::rcode::OK;
+		}
+
+		// Into a temporary sprite, a failed load must not change the size
+		olc::Sprite spr;
+		if (sSourceFile.empty() || spr.LoadFromFile(sSourceFile, pSourcePack) != olc::rcode::OK ||
+			spr.width != pSprite->width || spr.height != pSprite->height)
+			return olc::rcode::NO_FILE;
+		pSprite->pColData.swap(spr.pColData);
+		return olc::rcode::OK;
 	}
 
 	olc::rcode Renderable::Load(const std::string& sFile, ResourcePack* pack, bool filter, bool clamp)
 	{
+		bFilter = filter; bClamp = clamp;
 		pSprite = std::make_unique<olc::Sprite>();
 		if (pSprite->LoadFromFile(sFile, pack) == olc::rcode::OK)
 		{
+			sSourceFile = sFile; pSourcePack = pack;
+			nImageId = NextImageId();
 			pDecal = std::make_unique<olc::Decal>(pSprite.get(), filter, clamp);
+			MakeMips();
+			if (!bKeepPixels) ReleasePixels();
 			return olc::rcode::OK;
 		}
 		else
 		{
 			pSprite.release();
 			pSprite = nullptr;
+			sSourceFile.clear(); pSourcePack = nullptr;
+			nImageId = 0;
 			return olc::rcode::NO_FILE;
 		}
 	}
@@ -1480,6 +2018,15 @@ namespace olc
 	olc::Sprite* Renderable::Sprite() const
 	{ return pSprite.get(); }
 
+	uint64_t Renderable::ImageId() const
+	{ return nImageId; }
+
+	uint64_t Renderable::NextImageId()
+	{
+		static std::atomic<uint64_t> nNextId{ 0 };
+		return ++nNextId;
+	}
+
 	// O------------------------------------------------------------------------------O
 	// | olc::ResourcePack IMPLEMENTATION                                             |
 	// O------------------------------------------------------------------------------O
@@ -1495,8 +2042,78 @@ namespace olc
 		setg(vMemory.data(), vMemory.data(), vMemory.data() + size);
 	}
 
+	ResourceBuffer::ResourceBuffer(const ResourceView& view)
+	{
+		vMemory.assign(view.begin(), view.end());
+		setg(vMemory.data(), vMemory.data(), vMemory.data() + vMemory.size());
+	}
+
 	ResourcePack::ResourcePack() { }
-	ResourcePack::~ResourcePack() { baseFile.close(); }
+	ResourcePack::~ResourcePack() { ClosePack(); }
+
+	bool ResourcePack::OpenPack(const std::string& sFile)
+	{
+		ClosePack();
+#if defined(OLC_RESOURCEPACK_MMAP) && defined(OLC_PLATFORM_WINAPI)
+		hPackFile = CreateFileA(sFile.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+		if (hPackFile == INVALID_HANDLE_VALUE) return false;
+		LARGE_INTEGER nFileSize;
+		if (GetFileSizeEx(hPackFile, &nFileSize) && nFileSize.QuadPart > 0)
+		{
+			hPackMapping = CreateFileMappingA(hPackFile, nullptr, PAGE_READONLY, 0, 0, nullptr);
+			if (hPackMapping != nullptr)
+			{
+				pPackData = (const char*)MapViewOfFile(hPackMapping, FILE_MAP_READ, 0, 0, 0);
+				nPackSize = size_t(nFileSize.QuadPart);
+			}
+		}
+		if (pPackData != nullptr) return true;
+		ClosePack();
+#elif defined(OLC_RESOURCEPACK_MMAP)
+		int fd = open(sFile.c_str(), O_RDONLY);
+		if (fd < 0) return false;
+		struct stat st;
+		if (fstat(fd, &st) == 0 && st.st_size > 0)
+		{
+			void* pMap = mmap(nullptr, size_t(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+			if (pMap != MAP_FAILED)
+			{
+				pPackData = (const char*)pMap;
+				nPackSize = size_t(st.st_size);
+			}
+		}
+		// The mapping stays valid without the descriptor
+		close(fd);
+		if (pPackData != nullptr) return true;
+#endif
+		// No mapping, read all of it
+		std::ifstream ifs(sFile, std::ifstream::binary | std::ifstream::ate);
+		if (!ifs.is_open()) return false;
+		vPackData.resize(size_t(ifs.tellg()));
+		ifs.seekg(0);
+		ifs.read(vPackData.data(), vPackData.size());
+		if (!ifs || vPackData.empty()) { vPackData.clear(); return false; }
+		pPackData = vPackData.data();
+		nPackSize = vPackData.size();
+		return true;
+	}
+
+	void ResourcePack::ClosePack()
+	{
+#if defined(OLC_RESOURCEPACK_MMAP) && defined(OLC_PLATFORM_WINAPI)
+		if (pPackData != nullptr && vPackData.empty()) UnmapViewOfFile(pPackData);
+		if (hPackMapping != nullptr) CloseHandle(hPackMapping);
+		if (hPackFile != INVALID_HANDLE_VALUE) CloseHandle(hPackFile);
+		hPackMapping = nullptr;
+		hPackFile = INVALID_HANDLE_VALUE;
+#elif defined(OLC_RESOURCEPACK_MMAP)
+		if (pPackData != nullptr && vPackData.empty()) munmap((void*)pPackData, nPackSize);
+#endif
+		vPackData.clear();
+		vPackData.shrink_to_fit();
+		pPackData = nullptr;
+		nPackSize = 0;
+	}
 
 	bool ResourcePack::AddFile(const std::string& sFile)
 	{
@@ -1515,47 +2132,44 @@ namespace olc
 
 	bool ResourcePack::LoadPack(const std::string& sFile, const std::string& sKey)
 	{
-		// Open the resource file
-		baseFile.open(sFile, std::ifstream::binary);
-		if (!baseFile.is_open()) return false;
+		// Map the resource file, files are served straight from it
+		if (!OpenPack(sFile)) return false;
+		mapFiles.clear();
 
 		// 1) Read Scrambled index
 		uint32_t nIndexSize = 0;
-		baseFile.read((char*)&nIndexSize, sizeof(uint32_t));
-
-		std::vector<char> buffer(nIndexSize);
-		for (uint32_t j = 0; j < nIndexSize; j++)
-			buffer[j] = baseFile.get();
+		if (nPackSize < sizeof(uint32_t)) { ClosePack(); return false; }
+		memcpy(&nIndexSize, pPackData, sizeof(uint32_t));
+		if (nIndexSize > nPackSize - sizeof(uint32_t)) { ClosePack(); return false; }
 
+		std::vector<char> buffer(pPackData + sizeof(uint32_t), pPackData + sizeof(uint32_t) + nIndexSize);
 		std::vector<char> decoded = scramble(buffer, sKey);
 		size_t pos = 0;
-		auto read = [&decoded, &pos](char* dst, size_t size) {
+		auto read = [&decoded, &pos](char* dst, size_t size) -> bool {
+			if (size > decoded.size() - pos) return false;
 			memcpy((void*)dst, (const void*)(decoded.data() + pos), size);
 			pos += size;
+			return true;
 		};
 
-		auto get = [&read]() -> int { char c; read(&c, 1); return c; };
-
 		// 2) Read Map
 		uint32_t nMapEntries = 0;
-		read((char*)&nMapEntries, sizeof(uint32_t));
-		for (uint32_t i = 0; i < nMapEntries; i++)
+		bool bValid = read((char*)&nMapEntries, sizeof(uint32_t));
+		for (uint32_t i = 0; i < nMapEntries && bValid; i++)
 		{
 			uint32_t nFilePathSize = 0;
-			read((char*)&nFilePathSize, sizeof(uint32_t));
-
-			std::string sFileName(nFilePathSize, ' ');
-			for (uint32_t j = 0; j < nFilePathSize; j++)
-				sFileName[j] = get();
+			bValid = read((char*)&nFilePathSize, sizeof(uint32_t));
 
+			std::string sFileName(bValid ? nFilePathSize : 0, ' ');
 			sResourceFile e;
-			read((char*)&e.nSize, sizeof(uint32_t));
-			read((char*)&e.nOffset, sizeof(uint32_t));
-			mapFiles[sFileName] = e;
+			bValid = bValid && read(&sFileName[0], sFileName.size())
+				&& read((char*)&e.nSize, sizeof(uint32_t)) && read((char*)&e.nOffset, sizeof(uint32_t))
+				&& uint64_t(e.nOffset) + e.nSize <= nPackSize;
+			if (bValid) mapFiles[sFileName] = e;
 		}
 
-		// Don't close base file! we will provide a stream
-		// pointer when the file is requested
+		// Corrupt index, or the wrong key
+		if (!bValid) { ClosePack(); mapFiles.clear(); return false; }
 		return true;
 	}
 
@@ -1585,19 +2199,23 @@ namespace olc
 		// 2) Write the individual Data
 		std::streampos offset = ofs.tellp();
 		nIndexSize = (uint32_t)offset;
+		std::vector<char> vBuffer(1 << 20);
 		for (auto& e : mapFiles)
 		{
 			// Store beginning of file offset within resource pack file
 			e.second.nOffset = (uint32_t)offset;
 
-			// Load the file to be added
-			std::vector<uint8_t> vBuffer(e.second.nSize);
+			// Copy the file into the resource pack file in chunks, 
+			// large files are never held in memory as a whole
 			std::ifstream i(e.first, std::ifstream::binary);
-			i.read((char*)vBuffer.data(), e.second.nSize);
+			for (uint32_t nCopied = 0; nCopied < e.second.nSize; )
+			{
+				const uint32_t nChunk = std::min(e.second.nSize - nCopied, uint32_t(vBuffer.size()));
+				i.read(vBuffer.data(), nChunk);
+				ofs.write(vBuffer.data(), nChunk);
+				nCopied += nChunk;
+			}
 			i.close();
-
-			// Write the loaded file into resource pack file
-			ofs.write((char*)vBuffer.data(), e.second.nSize);
 			offset += e.second.nSize;
 		}
 
@@ -1634,20 +2252,78 @@ namespace olc
 	}
 
 	ResourceBuffer ResourcePack::GetFileBuffer(const std::string& sFile)
-	{ return ResourceBuffer(baseFile, mapFiles[sFile].nOffset, mapFiles[sFile].nSize); }
+	{ return ResourceBuffer(GetFileView(sFile)); }
+
+	ResourceView ResourcePack::GetFileView(const std::string& sFile)
+	{
+		ResourceView view;
+		auto it = mapFiles.find(sFile);
+		if (pPackData != nullptr && it != mapFiles.end())
+		{
+			view.pData = pPackData + it->second.nOffset;
+			view.nSize = it->second.nSize;
+		}
+		return view;
+	}
 
 	bool ResourcePack::Loaded()
-	{ return baseFile.is_open(); }
+	{ return pPackData != nullptr; }
 
 	std::vector<char> ResourcePack::scramble(const std::vector<char>& data, const std::string& key)
 	{
-		if (key.empty()) return data;
-		std::vector<char> o;
-		size_t c = 0;
-		for (auto s : data)	o.push_back(s ^ key[(c++) % key.size()]);
+		std::vector<char> o(data.size());
+		Scrambler(key).Process(data.data(), o.data(), data.size());
 		return o;
 	};
 
+	ResourcePack::Scrambler::Scrambler(const std::string& sKey)
+	{
+		nKeySize = sKey.size();
+		if (nKeySize == 0) return;
+		nStride = nKeySize * ((4096 + nKeySize - 1) / nKeySize);
+		vPattern.resize(nStride + nKeySize);
+		for (size_t i = 0; i < vPattern.size(); i++)
+			vPattern[i] = sKey[i % nKeySize];
+	}
+
+	void ResourcePack::Scrambler::Process(const char* src, char* dst, size_t size)
+	{
+		if (nKeySize == 0)
+		{
+			if (src != dst) memmove(dst, src, size);
+			return;
+		}
+
+		// nStride is a multiple of the key size, so each block of 
+		// nStride bytes starts at the same key offset
+		while (size > 0)
+		{
+			const size_t n = std::min(size, nStride);
+			const char* key = vPattern.data() + nKeyOffset;
+			size_t i = 0;
+#if defined(OLC_PGE_SSE2)
+			for (; i + 16 <= n; i += 16)
+			{
+				__m128i d = _mm_loadu_si128((const __m128i*)(src + i));
+				__m128i k = _mm_loadu_si128((const __m128i*)(key + i));
+				_mm_storeu_si128((__m128i*)(dst + i), _mm_xor_si128(d, k));
+			}
+#endif
+			for (; i + 8 <= n; i += 8)
+			{
+				uint64_t d, k;
+				memcpy(&d, src + i, 8); memcpy(&k, key + i, 8);
+				d ^= k;
+				memcpy(dst + i, &d, 8);
+			}
+			for (; i < n; i++)
+				dst[i] = src[i] ^ key[i];
+
+			nKeyOffset = (nKeyOffset + n) % nKeySize;
+			src += n; dst += n; size -= n;
+		}
+	}
+
 	std::string ResourcePack::makeposix(const std::string& path)
 	{
 		std::string o;
@@ -1742,6 +2418,7 @@ namespace olc
 			nTargetLayer = 0;
 			pDrawTarget = vLayers[0].pDrawTarget;
 		}
+		olc_UpdateDirtyLayer();
 	}
 
 	void PixelGameEngine::SetDrawTarget(uint8_t layer)
@@ -1751,6 +2428,7 @@ namespace olc
 			pDrawTarget = vLayers[layer].pDrawTarget;
 			vLayers[layer].bUpdate = true;
 			nTargetLayer = layer;
+			olc_UpdateDirtyLayer();
 		}
 	}
 
@@ -1788,6 +2466,114 @@ namespace olc
 		return uint32_t(vLayers.size()) - 1;
 	}
 
+	void PixelGameEngine::EnableLayerDirtyTracking(uint8_t layer, bool b)
+	{
+		if (layer >= vLayers.size()) return;
+		LayerDesc& ld = vLayers[layer];
+		ld.bDirtyTracking = b;
+		if (b)
+		{
+			// Everything is dirty to begin with, the texture may be stale
+			const olc::Sprite* spr = ld.pDrawTarget;
+			ld.nDirtyTilesX = (spr->width + LayerDesc::nDirtyTileSize - 1) >> LayerDesc::nDirtyTileShift;
+			const int32_t nTilesY = (spr->height + LayerDesc::nDirtyTileSize - 1) >> LayerDesc::nDirtyTileShift;
+			ld.vDirtyTiles.assign(size_t(ld.nDirtyTilesX) * nTilesY, 1);
+			ld.bUpdate = true;
+		}
+		else
+			ld.vDirtyTiles.clear();
+		olc_UpdateDirtyLayer();
+	}
+
+	void PixelGameEngine::MarkLayerDirty(uint8_t layer, const olc::vi2d& pos, const olc::vi2d& size)
+	{
+		if (layer >= vLayers.size()) return;
+		LayerDesc& ld = vLayers[layer];
+		ld.bUpdate = true;
+		olc_MarkDirty(ld, std::max(pos.x, 0), std::max(pos.y, 0),
+			std::min(pos.x + size.x, ld.pDrawTarget->width), std::min(pos.y + size.y, ld.pDrawTarget->height));
+	}
+
+	void PixelGameEngine::SetLayerDecalOnly(uint8_t layer, bool b)
+	{
+		if (layer >= vLayers.size()) return;
+		vLayers[layer].bDecalOnly = b;
+		vLayers[layer].bWritten = false;
+		olc_UpdateDirtyLayer();
+	}
+
+	uint64_t PixelGameEngine::GetLayerUploadBytes() const
+	{ return nLayerUploadBytes; }
+
+	void PixelGameEngine::olc_UpdateDirtyLayer()
+	{
+		nDirtyLayer = -1;
+		for (size_t i = 0; i < vLayers.size(); i++)
+			if ((vLayers[i].bDirtyTracking || vLayers[i].bDecalOnly) && vLayers[i].pDrawTarget == pDrawTarget)
+				nDirtyLayer = int32_t(i);
+	}
+
+	void PixelGameEngine::olc_MarkDirty(LayerDesc& layer, int32_t x0, int32_t y0, int32_t x1, int32_t y1)
+	{
+		if (x0 >= x1 || y0 >= y1) return;
+		layer.bWritten = true;
+		if (!layer.bDirtyTracking) return;
+		const int32_t tx1 = (x1 - 1) >> LayerDesc::nDirtyTileShift;
+		const int32_t ty1 = (y1 - 1) >> LayerDesc::nDirtyTileShift;
+		for (int32_t ty = y0 >> LayerDesc::nDirtyTileShift; ty <= ty1; ty++)
+		{
+			uint8_t* pRow = layer.vDirtyTiles.data() + size_t(ty) * layer.nDirtyTilesX;
+			std::fill(pRow + (x0 >> LayerDesc::nDirtyTileShift), pRow + tx1 + 1, uint8_t(1));
+		}
+	}
+
+	uint64_t PixelGameEngine::olc_UploadDirtyTiles(LayerDesc& layer)
+	{
+		olc::Sprite* spr = layer.pDrawTarget;
+		const size_t nTiles = layer.vDirtyTiles.size();
+		const size_t nDirty = size_t(std::count(layer.vDirtyTiles.begin(), layer.vDirtyTiles.end(), uint8_t(1)));
+		uint64_t nBytes = 0;
+		if (nDirty == nTiles)
+		{
+			renderer->UpdateTexture(layer.nResID, spr);
+			nBytes = uint64_t(spr->width) * spr->height * sizeof(Pixel);
+		}
+		else if (nDirty > 0 && !renderer->UpdatesPartialRows())
+		{
+			// Whole rows only, one upload from the first to the last dirty row
+			auto itFirst = std::find(layer.vDirtyTiles.begin(), layer.vDirtyTiles.end(), uint8_t(1));
+			auto itLast = std::find(layer.vDirtyTiles.rbegin(), layer.vDirtyTiles.rend(), uint8_t(1));
+			const int32_t ty0 = int32_t((itFirst - layer.vDirtyTiles.begin()) / layer.nDirtyTilesX);
+			const int32_t ty1 = int32_t((layer.vDirtyTiles.rend() - itLast - 1) / layer.nDirtyTilesX);
+			const int32_t y0 = ty0 << LayerDesc::nDirtyTileShift;
+			const int32_t y1 = std::min((ty1 + 1) << LayerDesc::nDirtyTileShift, spr->height);
+			nBytes = renderer->UpdateTextureRegion(layer.nResID, spr, { 0, y0 }, { spr->width, y1 - y0 });
+		}
+		else if (nDirty > 0)
+		{
+			// One upload per horizontal run of dirty tiles
+			const int32_t nTilesY = int32_t(nTiles / layer.nDirtyTilesX);
+			for (int32_t ty = 0; ty < nTilesY; ty++)
+			{
+				const uint8_t* pRow = layer.vDirtyTiles.data() + size_t(ty) * layer.nDirtyTilesX;
+				for (int32_t tx = 0; tx < layer.nDirtyTilesX; tx++)
+				{
+					if (!pRow[tx]) continue;
+					int32_t tx2 = tx;
+					while (tx2 + 1 < layer.nDirtyTilesX && pRow[tx2 + 1]) tx2++;
+					const olc::vi2d vPos = { tx << LayerDesc::nDirtyTileShift, ty << LayerDesc::nDirtyTileShift };
+					const olc::vi2d vSize = {
+						std::min((tx2 + 1) << LayerDesc::nDirtyTileShift, spr->width) - vPos.x,
+						std::min((ty + 1) << LayerDesc::nDirtyTileShift, spr->height) - vPos.y };
+					nBytes += renderer->UpdateTextureRegion(layer.nResID, spr, vPos, vSize);
+					tx = tx2;
+				}
+			}
+		}
+		std::fill(layer.vDirtyTiles.begin(), layer.vDirtyTiles.end(), uint8_t(0));
+		return nBytes;
+	}
+
 	Sprite* PixelGameEngine::GetDrawTarget() const
 	{ return pDrawTarget; }
 
@@ -1860,6 +2646,14 @@ namespace olc
 	{
 		if (!pDrawTarget) return false;
 
+		if (nDirtyLayer >= 0 && x >= 0 && y >= 0 && x < pDrawTarget->width && y < pDrawTarget->height)
+		{
+			LayerDesc& ld = vLayers[nDirtyLayer];
+			ld.bWritten = true;
+			if (ld.bDirtyTracking)
+				ld.vDirtyTiles[size_t(y >> LayerDesc::nDirtyTileShift) * ld.nDirtyTilesX + (x >> LayerDesc::nDirtyTileShift)] = 1;
+		}
+
 		if (nPixelMode == Pixel::NORMAL)
 		{
 			return pDrawTarget->SetPixel(x, y, p);
@@ -2070,6 +2864,7 @@ namespace olc
 		int pixels = GetDrawTargetWidth() * GetDrawTargetHeight();
 		Pixel* m = GetDrawTarget()->GetData();
 		for (int i = 0; i < pixels; i++) m[i] = p;
+		if (nDirtyLayer >= 0) olc_MarkDirty(vLayers[nDirtyLayer], 0, 0, GetDrawTargetWidth(), GetDrawTargetHeight());
 	}
 
 	void PixelGameEngine::ClearBuffer(Pixel p, bool bDepth)
@@ -2250,6 +3045,207 @@ namespace olc
 		}
 	}
 
+	bool PixelGameEngine::olc_BlitSprite(int32_t x, int32_t y, const Sprite* sprite, int32_t ox, int32_t oy, int32_t w, int32_t h, uint8_t flip)
+	{
+		if (!pDrawTarget || nPixelMode == Pixel::CUSTOM)
+			return false;
+		// Pixels dropped after upload, nothing to draw
+		if (sprite->pColData.empty())
+			return true;
+
+		// Outside of the sprite GetPixel() gives blank or wrapped pixels,
+		// leave that to the per pixel path
+		if (ox < 0 || oy < 0 || ox + w > sprite->width || oy + h > sprite->height)
+			return false;
+
+		// Clip the destination rectangle once
+		int32_t x0 = std::max(x, 0), x1 = std::min(x + w, pDrawTarget->width);
+		int32_t y0 = std::max(y, 0), y1 = std::min(y + h, pDrawTarget->height);
+		if (x0 >= x1 || y0 >= y1)
+			return true;
+
+		const int32_t nCount = x1 - x0;
+		const uint32_t nBlend = (uint32_t)(std::min(std::max(fBlendFactor, 0.0f), 1.0f) * 257.0f + 0.5f);
+		const bool bFlipX = (flip & olc::Sprite::Flip::HORIZ) != 0;
+		const bool bFlipY = (flip & olc::Sprite::Flip::VERT) != 0;
+		if (bFlipX) vBlitRow.resize(nCount);
+		if (nDirtyLayer >= 0) olc_MarkDirty(vLayers[nDirtyLayer], x0, y0, x1, y1);
+
+		for (int32_t j = y0; j < y1; j++)
+		{
+			const int32_t sy = oy + (bFlipY ? h - 1 - (j - y) : j - y);
+			const Pixel* pSrc = sprite->pColData.data() + sy * sprite->width + ox;
+			if (bFlipX)
+			{
+				// Source columns w - 1 - (x0 - x) down to w - 1 - (x1 - 1 - x)
+				const Pixel* pRev = pSrc + (w - 1 - (x0 - x));
+				for (int32_t i = 0; i < nCount; i++)
+					vBlitRow[i] = pRev[-i];
+				pSrc = vBlitRow.data();
+			}
+			else
+				pSrc += x0 - x;
+
+			olc_BlitRow(pDrawTarget->pColData.data() + j * pDrawTarget->width + x0, pSrc, nCount, nPixelMode, nBlend);
+		}
+		return true;
+	}
+
+	void PixelGameEngine::olc_BlitRow(Pixel* dst, const Pixel* src, int32_t count, Pixel::Mode mode, uint32_t blend)
+	{
+		if (mode == Pixel::NORMAL)
+		{
+			std::memcpy(dst, src, count * sizeof(Pixel));
+			return;
+		}
+
+		int32_t i = 0;
+		if (mode == Pixel::MASK)
+		{
+			// Only fully opaque source pixels are written
+#if defined(OLC_PGE_AVX2)
+			const __m256i m256Alpha = _mm256_set1_epi32((int)0xFF000000);
+			for (; i + 8 <= count; i += 8)
+			{
+				__m256i s = _mm256_loadu_si256((const __m256i*)(src + i));
+				__m256i d = _mm256_loadu_si256((const __m256i*)(dst + i));
+				__m256i m = _mm256_cmpeq_epi32(_mm256_and_si256(s, m256Alpha), m256Alpha);
+				_mm256_storeu_si256((__m256i*)(dst + i), _mm256_blendv_epi8(d, s, m));
+			}
+#endif
+#if defined(OLC_PGE_SSE2)
+			const __m128i mAlpha = _mm_set1_epi32((int)0xFF000000);
+			for (; i + 4 <= count; i += 4)
+			{
+				__m128i s = _mm_loadu_si128((const __m128i*)(src + i));
+				__m128i d = _mm_loadu_si128((const __m128i*)(dst + i));
+				__m128i m = _mm_cmpeq_epi32(_mm_and_si128(s, mAlpha), mAlpha);
+				_mm_storeu_si128((__m128i*)(dst + i), _mm_or_si128(_mm_and_si128(m, s), _mm_andnot_si128(m, d)));
+			}
+#endif
+			for (; i < count; i++)
+				if (src[i].a == 255) dst[i] = src[i];
+			return;
+		}
+
+		// Pixel::ALPHA in 8 bit fixed point, a = source alpha * blend factor 
+		// in 0 - 256, dst = (src * a + dst * (256 - a)) / 256 and alpha is 255.
+		// The SIMD paths give exactly the same result as the scalar one
+#if defined(OLC_PGE_AVX2)
+		{
+			const __m256i zero = _mm256_setzero_si256();
+			const __m256i m256Blend = _mm256_set1_epi16((short)blend);
+			const __m256i m256Round = _mm256_set1_epi16(128);
+			const __m256i m256Full = _mm256_set1_epi16(256);
+			const __m256i m256Alpha = _mm256_set1_epi32((int)0xFF000000);
+			auto lerp = [&](__m256i s, __m256i d)
+			{
+				__m256i a = _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(s, 0xFF), 0xFF);
+				a = _mm256_mulhi_epu16(_mm256_add_epi16(_mm256_slli_epi16(a, 8), m256Round), m256Blend);
+				__m256i r = _mm256_add_epi16(_mm256_mullo_epi16(s, a), _mm256_mullo_epi16(d, _mm256_sub_epi16(m256Full, a)));
+				return _mm256_srli_epi16(r, 8);
+			};
+			for (; i + 8 <= count; i += 8)
+			{
+				__m256i s = _mm256_loadu_si256((const __m256i*)(src + i));
+				__m256i d = _mm256_loadu_si256((const __m256i*)(dst + i));
+				__m256i lo = lerp(_mm256_unpacklo_epi8(s, zero), _mm256_unpacklo_epi8(d, zero));
+				__m256i hi = lerp(_mm256_unpackhi_epi8(s, zero), _mm256_unpackhi_epi8(d, zero));
+				_mm256_storeu_si256((__m256i*)(dst + i), _mm256_or_si256(_mm256_packus_epi16(lo, hi), m256Alpha));
+			}
+		}
+#endif
+#if defined(OLC_PGE_SSE2)
+		{
+			const __m128i zero = _mm_setzero_si128();
+			const __m128i mBlend = _mm_set1_epi16((short)blend);
+			const __m128i mRound = _mm_set1_epi16(128);
+			const __m128i mFull = _mm_set1_epi16(256);
+			const __m128i mAlpha = _mm_set1_epi32((int)0xFF000000);
+			auto lerp = [&](__m128i s, __m128i d)
+			{
+				__m128i a = _mm_shufflehi_epi16(_mm_shufflelo_epi16(s, 0xFF), 0xFF);
+				a = _mm_mulhi_epu16(_mm_add_epi16(_mm_slli_epi16(a, 8), mRound), mBlend);
+				__m128i r = _mm_add_epi16(_mm_mullo_epi16(s, a), _mm_mullo_epi16(d, _mm_sub_epi16(mFull, a)));
+				return _mm_srli_epi16(r, 8);
+			};
+			for (; i + 4 <= count; i += 4)
+			{
+				__m128i s = _mm_loadu_si128((const __m128i*)(src + i));
+				__m128i d = _mm_loadu_si128((const __m128i*)(dst + i));
+				__m128i lo = lerp(_mm_unpacklo_epi8(s, zero), _mm_unpacklo_epi8(d, zero));
+				__m128i hi = lerp(_mm_unpackhi_epi8(s, zero), _mm_unpackhi_epi8(d, zero));
+				_mm_storeu_si128((__m128i*)(dst + i), _mm_or_si128(_mm_packus_epi16(lo, hi), mAlpha));
+			}
+		}
+#endif
+		for (; i < count; i++)
+		{
+			const uint32_t a = ((((uint32_t)src[i].a << 8) + 128) * blend) >> 16;
+			const uint32_t c = 256 - a;
+			dst[i] = Pixel(
+				(uint8_t)((src[i].r * a + dst[i].r * c) >> 8),
+				(uint8_t)((src[i].g * a + dst[i].g * c) >> 8),
+				(uint8_t)((src[i].b * a + dst[i].b * c) >> 8));
+		}
+	}
+
+	void PixelGameEngine::olc_BlitScaledSprite(const olc::vf2d& pos, const Sprite* sprite, int32_t ox, int32_t oy, int32_t w, int32_t h, const olc::vf2d& scale, uint8_t flip)
+	{
+		if (!pDrawTarget || w <= 0 || h <= 0 || scale.x <= 0.0f || scale.y <= 0.0f || sprite->pColData.empty())
+			return;
+
+		// Destination pixels whose centres are inside the scaled rectangle, clipped once
+		const int32_t x0 = std::max((int32_t)std::ceil(pos.x - 0.5f), 0);
+		const int32_t x1 = std::min((int32_t)std::ceil(pos.x + w * scale.x - 0.5f), pDrawTarget->width);
+		const int32_t y0 = std::max((int32_t)std::ceil(pos.y - 0.5f), 0);
+		const int32_t y1 = std::min((int32_t)std::ceil(pos.y + h * scale.y - 0.5f), pDrawTarget->height);
+		if (x0 >= x1 || y0 >= y1)
+			return;
+
+		// Source column of each destination column, 16.16 DDA sampled at pixel 
+		// centres so that integer scales repeat every source pixel exactly
+		const int32_t nCount = x1 - x0;
+		const bool bFlipX = (flip & olc::Sprite::Flip::HORIZ) != 0;
+		const bool bFlipY = (flip & olc::Sprite::Flip::VERT) != 0;
+		const int32_t du = (int32_t)std::lround(65536.0 / scale.x);
+		int32_t u = (int32_t)std::lround((x0 + 0.5 - pos.x) / scale.x * 65536.0);
+		vBlitColumns.resize(nCount);
+		for (int32_t i = 0; i < nCount; i++, u += du)
+		{
+			const int32_t sx = std::min(std::max(u >> 16, 0), w - 1);
+			vBlitColumns[i] = ox + (bFlipX ? w - 1 - sx : sx);
+		}
+
+		// Blank or wrapped source pixels and custom pixel modes go through Draw()
+		const bool bPerPixel = nPixelMode == Pixel::CUSTOM || ox < 0 || oy < 0 || ox + w > sprite->width || oy + h > sprite->height;
+		if (!bPerPixel && nDirtyLayer >= 0) olc_MarkDirty(vLayers[nDirtyLayer], x0, y0, x1, y1);
+		const uint32_t nBlend = (uint32_t)(std::min(std::max(fBlendFactor, 0.0f), 1.0f) * 257.0f + 0.5f);
+		vBlitRow.resize(nCount);
+		int32_t nLastRow = -1;
+		for (int32_t j = y0; j < y1; j++)
+		{
+			const int32_t v = std::min(std::max((int32_t)std::floor((j + 0.5 - pos.y) / scale.y), 0), h - 1);
+			const int32_t sy = oy + (bFlipY ? h - 1 - v : v);
+			if (bPerPixel)
+			{
+				for (int32_t i = 0; i < nCount; i++)
+					Draw(x0 + i, j, sprite->GetPixel(vBlitColumns[i], sy));
+				continue;
+			}
+
+			// Rows repeated by the scale reuse the gathered source row
+			if (sy != nLastRow)
+			{
+				const Pixel* pSrc = sprite->pColData.data() + sy * sprite->width;
+				for (int32_t i = 0; i < nCount; i++)
+					vBlitRow[i] = pSrc[vBlitColumns[i]];
+				nLastRow = sy;
+			}
+			olc_BlitRow(pDrawTarget->pColData.data() + j * pDrawTarget->width + x0, vBlitRow.data(), nCount, nPixelMode, nBlend);
+		}
+	}
+
 	void PixelGameEngine::DrawSprite(const olc::vi2d& pos, Sprite* sprite, uint32_t scale, uint8_t flip)
 	{ DrawSprite(pos.x, pos.y, sprite, scale, flip); }
 
@@ -2258,32 +3254,26 @@ namespace olc
 		if (sprite == nullptr)
 			return;
 
+		if (scale > 1)
+		{
+			olc_BlitScaledSprite({ float(x), float(y) }, sprite, 0, 0, sprite->width, sprite->height, { float(scale), float(scale) }, flip);
+			return;
+		}
+
+		if (olc_BlitSprite(x, y, sprite, 0, 0, sprite->width, sprite->height, flip))
+			return;
+
 		int32_t fxs = 0, fxm = 1, fx = 0;
 		int32_t fys = 0, fym = 1, fy = 0;
 		if (flip & olc::Sprite::Flip::HORIZ) { fxs = sprite->width - 1; fxm = -1; }
 		if (flip & olc::Sprite::Flip::VERT) { fys = sprite->height - 1; fym = -1; }
 
-		if (scale > 1)
+		fx = fxs;
+		for (int32_t i = 0; i < sprite->width; i++, fx += fxm)
 		{
-			fx = fxs;
-			for (int32_t i = 0; i < sprite->width; i++, fx += fxm)
-			{
-				fy = fys;
-				for (int32_t j = 0; j < sprite->height; j++, fy += fym)
-					for (uint32_t is = 0; is < scale; is++)
-						for (uint32_t js = 0; js < scale; js++)
-							Draw(x + (i * scale) + is, y + (j * scale) + js, sprite->GetPixel(fx, fy));
-			}
-		}
-		else
-		{
-			fx = fxs;
-			for (int32_t i = 0; i < sprite->width; i++, fx += fxm)
-			{
-				fy = fys;
-				for (int32_t j = 0; j < sprite->height; j++, fy += fym)
-					Draw(x + i, y + j, sprite->GetPixel(fx, fy));
-			}
+			fy = fys;
+			for (int32_t j = 0; j < sprite->height; j++, fy += fym)
+				Draw(x + i, y + j, sprite->GetPixel(fx, fy));
 		}
 	}
 
@@ -2295,35 +3285,43 @@ namespace olc
 		if (sprite == nullptr)
 			return;
 
+		if (scale > 1)
+		{
+			olc_BlitScaledSprite({ float(x), float(y) }, sprite, ox, oy, w, h, { float(scale), float(scale) }, flip);
+			return;
+		}
+
+		if (olc_BlitSprite(x, y, sprite, ox, oy, w, h, flip))
+			return;
+
 		int32_t fxs = 0, fxm = 1, fx = 0;
 		int32_t fys = 0, fym = 1, fy = 0;
 		if (flip & olc::Sprite::Flip::HORIZ) { fxs = w - 1; fxm = -1; }
 		if (flip & olc::Sprite::Flip::VERT) { fys = h - 1; fym = -1; }
 
-		if (scale > 1)
+		fx = fxs;
+		for (int32_t i = 0; i < w; i++, fx += fxm)
 		{
-			fx = fxs;
-			for (int32_t i = 0; i < w; i++, fx += fxm)
-			{
-				fy = fys;
-				for (int32_t j = 0; j < h; j++, fy += fym)
-					for (uint32_t is = 0; is < scale; is++)
-						for (uint32_t js = 0; js < scale; js++)
-							Draw(x + (i * scale) + is, y + (j * scale) + js, sprite->GetPixel(fx + ox, fy + oy));
-			}
-		}
-		else
-		{
-			fx = fxs;
-			for (int32_t i = 0; i < w; i++, fx += fxm)
-			{
-				fy = fys;
-				for (int32_t j = 0; j < h; j++, fy += fym)
-					Draw(x + i, y + j, sprite->GetPixel(fx + ox, fy + oy));
-			}
+			fy = fys;
+			for (int32_t j = 0; j < h; j++, fy += fym)
+				Draw(x + i, y + j, sprite->GetPixel(fx + ox, fy + oy));
 		}
 	}
 
+	void PixelGameEngine::DrawScaledSprite(const olc::vf2d& pos, Sprite* sprite, const olc::vf2d& scale, uint8_t flip)
+	{
+		if (sprite == nullptr)
+			return;
+		olc_BlitScaledSprite(pos, sprite, 0, 0, sprite->width, sprite->height, scale, flip);
+	}
+
+	void PixelGameEngine::DrawPartialScaledSprite(const olc::vf2d& pos, Sprite* sprite, const olc::vi2d& sourcepos, const olc::vi2d& size, const olc::vf2d& scale, uint8_t flip)
+	{
+		if (sprite == nullptr)
+			return;
+		olc_BlitScaledSprite(pos, sprite, sourcepos.x, sourcepos.y, size.x, size.y, scale, flip);
+	}
+
 	void PixelGameEngine::SetDecalMode(const olc::DecalMode& mode)
 	{ nDecalMode = mode; }
 
@@ -2971,20 +3969,32 @@ namespace olc
 		SetDecalMode(DecalMode::NORMAL);
 		renderer->PrepareDrawing();
 
+		uint64_t nUploadBytes = 0;
 		for (auto layer = vLayers.rbegin(); layer != vLayers.rend(); ++layer)
 		{
 			if (layer->bShow)
 			{
 				if (layer->funcHook == nullptr)
 				{
-					renderer->ApplyTexture(layer->nResID);
-					if (layer->bUpdate)
+					// Nothing was drawn into a decal only layer, so there is nothing to show but its decals
+					if (!layer->bDecalOnly || layer->bWritten)
 					{
-						renderer->UpdateTexture(layer->nResID, layer->pDrawTarget);
-						layer->bUpdate = false;
+						renderer->ApplyTexture(layer->nResID);
+						if (layer->bUpdate)
+						{
+							if (layer->bDirtyTracking)
+								nUploadBytes += olc_UploadDirtyTiles(*layer);
+							else
+							{
+								renderer->UpdateTexture(layer->nResID, layer->pDrawTarget);
+								nUploadBytes += uint64_t(layer->pDrawTarget->width) * layer->pDrawTarget->height * sizeof(Pixel);
+							}
+							layer->bUpdate = false;
+						}
+
+						renderer->DrawLayerQuad(layer->vOffset, layer->vScale, layer->tint);
 					}
-
-					renderer->DrawLayerQuad(layer->vOffset, layer->vScale, layer->tint);
+					layer->bWritten = false;
 
 					// Display Decals in order for this layer
 					for (auto& decal : layer->vecDecalInstance)
@@ -2998,6 +4008,7 @@ namespace olc
 				}
 			}
 		}
+		nLayerUploadBytes = nUploadBytes;
 
 		// Present Graphics to screen
 		renderer->DisplayFrame();
@@ -3087,6 +4098,7 @@ namespace olc
 	olc::PixelGameEngine* olc::Platform::ptrPGE = nullptr;
 	olc::PixelGameEngine* olc::Renderer::ptrPGE = nullptr;
 	std::unique_ptr<ImageLoader> olc::Sprite::loader = nullptr;
+	std::string olc::Sprite::sRawCache;
 };
 #pragma endregion 
 
@@ -3398,9 +4410,34 @@ namespace olc
 			glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, spr->width, spr->height, 0, GL_RGBA, GL_UNSIGNED_BYTE, spr->GetData());
 		}
 
+		uint64_t UpdateTextureRegion(uint32_t id, olc::Sprite* spr, const olc::vi2d& pos, const olc::vi2d& size) override
+		{
+			UNUSED(id);
+#if defined(GL_UNPACK_ROW_LENGTH)
+			glPixelStorei(GL_UNPACK_ROW_LENGTH, spr->width);
+			glTexSubImage2D(GL_TEXTURE_2D, 0, pos.x, pos.y, size.x, size.y, GL_RGBA, GL_UNSIGNED_BYTE, spr->GetData() + pos.y * spr->width + pos.x);
+			glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+			return uint64_t(size.x) * size.y * sizeof(Pixel);
+#else
+			// No row length, so upload whole rows
+			glTexSubImage2D(GL_TEXTURE_2D, 0, 0, pos.y, spr->width, size.y, GL_RGBA, GL_UNSIGNED_BYTE, spr->GetData() + pos.y * spr->width);
+			return uint64_t(spr->width) * size.y * sizeof(Pixel);
+#endif
+		}
+
+		bool UpdatesPartialRows() const override
+		{
+#if defined(GL_UNPACK_ROW_LENGTH)
+			return true;
+#else
+			return false;
+#endif
+		}
+
 		void ReadTexture(uint32_t id, olc::Sprite* spr) override
 		{
-			glReadPixels(0, 0, spr->width, spr->height, GL_RGBA, GL_UNSIGNED_BYTE, spr->GetData());
+			// Level 0 of the texture bound by ApplyTexture()
+			glGetTexImage(GL_TEXTURE_2D, 0, GL_RGBA, GL_UNSIGNED_BYTE, spr->GetData());
 		}
 
 		void ApplyTexture(uint32_t id) override
@@ -3923,9 +4960,39 @@ namespace olc
 			glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, spr->width, spr->height, 0, GL_RGBA, GL_UNSIGNED_BYTE, spr->GetData());
 		}
 
+		uint64_t UpdateTextureRegion(uint32_t id, olc::Sprite* spr, const olc::vi2d& pos, const olc::vi2d& size) override
+		{
+			UNUSED(id);
+#if defined(GL_UNPACK_ROW_LENGTH)
+			glPixelStorei(GL_UNPACK_ROW_LENGTH, spr->width);
+			glTexSubImage2D(GL_TEXTURE_2D, 0, pos.x, pos.y, size.x, size.y, GL_RGBA, GL_UNSIGNED_BYTE, spr->GetData() + pos.y * spr->width + pos.x);
+			glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+			return uint64_t(size.x) * size.y * sizeof(Pixel);
+#else
+			// No row length, so upload whole rows
+			glTexSubImage2D(GL_TEXTURE_2D, 0, 0, pos.y, spr->width, size.y, GL_RGBA, GL_UNSIGNED_BYTE, spr->GetData() + pos.y * spr->width);
+			return uint64_t(spr->width) * size.y * sizeof(Pixel);
+#endif
+		}
+
+		bool UpdatesPartialRows() const override
+		{
+#if defined(GL_UNPACK_ROW_LENGTH)
+			return true;
+#else
+			return false;
+#endif
+		}
+
 		void ReadTexture(uint32_t id, olc::Sprite* spr) override
 		{
+#if defined(OLC_PLATFORM_EMSCRIPTEN)
+			// No glGetTexImage() in GLES, reads the framebuffer instead
 			glReadPixels(0, 0, spr->width, spr->height, GL_RGBA, GL_UNSIGNED_BYTE, spr->GetData());
+#else
+			// Level 0 of the texture bound by ApplyTexture()
+			glGetTexImage(GL_TEXTURE_2D, 0, GL_RGBA, GL_UNSIGNED_BYTE, spr->GetData());
+#endif
 		}
 
 		void ApplyTexture(uint32_t id) override
@@ -4040,8 +5107,8 @@ namespace olc
 			if (pack != nullptr)
 			{
 				// Load sprite from input stream
-				ResourceBuffer rb = pack->GetFileBuffer(sImageFile);
-				bmp = Gdiplus::Bitmap::FromStream(SHCreateMemStream((BYTE*)rb.vMemory.data(), UINT(rb.vMemory.size())));
+				ResourceView view = pack->GetFileView(sImageFile);
+				bmp = Gdiplus::Bitmap::FromStream(SHCreateMemStream((const BYTE*)view.data(), UINT(view.size())));
 			}
 			else
 			{
@@ -4058,17 +5125,52 @@ namespace olc
 
 			spr->pColData.resize(spr->width * spr->height);
 
-			for (int y = 0; y < spr->height; y++)
-				for (int x = 0; x < spr->width; x++)
-				{
-					Gdiplus::Color c;
-					bmp->GetPixel(x, y, &c);
-					spr->SetPixel(x, y, olc::Pixel(c.GetRed(), c.GetGreen(), c.GetBlue(), c.GetAlpha()));
-				}
+			// Let GDI+ convert the whole image straight into the sprite
+			Gdiplus::Rect rect(0, 0, spr->width, spr->height);
+			Gdiplus::BitmapData data;
+			data.Width = spr->width;
+			data.Height = spr->height;
+			data.Stride = spr->width * sizeof(olc::Pixel);
+			data.PixelFormat = PixelFormat32bppARGB;
+			data.Scan0 = spr->pColData.data();
+			data.Reserved = 0;
+			if (bmp->LockBits(&rect, Gdiplus::ImageLockModeRead | Gdiplus::ImageLockModeUserInputBuf, PixelFormat32bppARGB, &data) == Gdiplus::Ok)
+			{
+				bmp->UnlockBits(&data);
+				SwapRedBlue(spr->pColData.data(), spr->pColData.size());
+			}
+			else
+			{
+				for (int y = 0; y < spr->height; y++)
+					for (int x = 0; x < spr->width; x++)
+					{
+						Gdiplus::Color c;
+						bmp->GetPixel(x, y, &c);
+						spr->SetPixel(x, y, olc::Pixel(c.GetRed(), c.GetGreen(), c.GetBlue(), c.GetAlpha()));
+					}
+			}
 			delete bmp;
 			return olc::rcode::OK;
 		}
 
+		// GDI+ ARGB is BGRA in memory
+		static void SwapRedBlue(olc::Pixel* p, size_t count)
+		{
+			size_t i = 0;
+#if defined(OLC_PGE_SSE2)
+			const __m128i mGA = _mm_set1_epi32((int)0xFF00FF00);
+			const __m128i mB = _mm_set1_epi32(0x000000FF);
+			for (; i + 4 <= count; i += 4)
+			{
+				__m128i v = _mm_loadu_si128((const __m128i*)(p + i));
+				__m128i rb = _mm_or_si128(_mm_and_si128(_mm_srli_epi32(v, 16), mB), _mm_slli_epi32(_mm_and_si128(v, mB), 16));
+				_mm_storeu_si128((__m128i*)(p + i), _mm_or_si128(_mm_and_si128(v, mGA), rb));
+			}
+#endif
+			for (; i < count; i++)
+				p[i].n = (p[i].n & 0xFF00FF00) | ((p[i].n >> 16) & 0xFF) | ((p[i].n & 0xFF) << 16);
+		}
+
 		olc::rcode SaveImageResource(olc::Sprite* spr, const std::string& sImageFile) override
 		{
 			return olc::rcode::OK;
@@ -4095,6 +5197,15 @@ namespace olc
 		((std::istream*)a)->read((char*)data, length);
 	}
 
+	void pngReadView(png_structp pngPtr, png_bytep data, png_size_t length)
+	{
+		olc::ResourceView* view = (olc::ResourceView*)png_get_io_ptr(pngPtr);
+		if (length > view->nSize) png_error(pngPtr, "Read past the end of resource");
+		memcpy(data, view->pData, length);
+		view->pData += length;
+		view->nSize -= length;
+	}
+
 	class ImageLoader_LibPNG : public olc::ImageLoader
 	{
 	public:
@@ -4115,13 +5226,14 @@ namespace olc
 			// http://www.piko3d.net/tutorials/libpng-tutorial-loading-png-files-from-streams/
 			png_structp png;
 			png_infop info;
+			// Outside of loadPNG(), so that a png_error() longjmp skips no destructor
+			std::vector<png_bytep> vRows;
 
 			auto loadPNG = [&]()
 			{
 				png_read_info(png, info);
 				png_byte color_type;
 				png_byte bit_depth;
-				png_bytep* row_pointers;
 				spr->width = png_get_image_width(png, info);
 				spr->height = png_get_image_height(png, info);
 				color_type = png_get_color_type(png, info);
@@ -4135,28 +5247,15 @@ namespace olc
 				if (color_type == PNG_COLOR_TYPE_GRAY || color_type == PNG_COLOR_TYPE_GRAY_ALPHA)
 					png_set_gray_to_rgb(png);
 				png_read_update_info(png, info);
-				row_pointers = (png_bytep*)malloc(sizeof(png_bytep) * spr->height);
-				for (int y = 0; y < spr->height; y++) {
-					row_pointers[y] = (png_byte*)malloc(png_get_rowbytes(png, info));
-				}
-				png_read_image(png, row_pointers);
-				////////////////////////////////////////////////////////////////////////////
-				// Create sprite array
+				// The transforms above give 8 bit RGBA, which is the sprite 
+				// format, so libpng converts the rows straight into the sprite
+				if (png_get_rowbytes(png, info) != spr->width * sizeof(olc::Pixel))
+					png_error(png, "Unexpected row format");
 				spr->pColData.resize(spr->width * spr->height);
-				// Iterate through image rows, converting into sprite format
+				vRows.resize(spr->height);
 				for (int y = 0; y < spr->height; y++)
-				{
-					png_bytep row = row_pointers[y];
-					for (int x = 0; x < spr->width; x++)
-					{
-						png_bytep px = &(row[x * 4]);
-						spr->SetPixel(x, y, Pixel(px[0], px[1], px[2], px[3]));
-					}
-				}
-
-				for (int y = 0; y < spr->height; y++) // Thanks maksym33
-					free(row_pointers[y]);
-				free(row_pointers);
+					vRows[y] = (png_bytep)(spr->pColData.data() + y * spr->width);
+				png_read_image(png, vRows.data());
 				png_destroy_read_struct(&png, &info, nullptr);
 			};
 
@@ -4178,9 +5277,8 @@ namespace olc
 			}
 			else
 			{
-				ResourceBuffer rb = pack->GetFileBuffer(sImageFile);
-				std::istream is(&rb);
-				png_set_read_fn(png, (png_voidp)&is, pngReadStream);
+				ResourceView view = pack->GetFileView(sImageFile);
+				png_set_read_fn(png, (png_voidp)&view, pngReadView);
 				loadPNG();
 			}
 
@@ -4238,8 +5336,8 @@ namespace olc
 			int w = 0, h = 0, cmp = 0;
 			if (pack != nullptr)
 			{
-				ResourceBuffer rb = pack->GetFileBuffer(sImageFile);
-				bytes = stbi_load_from_memory((unsigned char*)rb.vMemory.data(), rb.vMemory.size(), &w, &h, &cmp, 4);
+				ResourceView view = pack->GetFileView(sImageFile);
+				bytes = stbi_load_from_memory((const stbi_uc*)view.data(), int(view.size()), &w, &h, &cmp, 4);
 			}
 			else
 			{
@@ -4252,7 +5350,7 @@ namespace olc
 			spr->width = w; spr->height = h;
 			spr->pColData.resize(spr->width * spr->height);
 			std::memcpy(spr->pColData.data(), bytes, spr->width * spr->height * 4);
-			delete[] bytes;
+			stbi_image_free(bytes);
 			return olc::rcode::OK;
 		}
 